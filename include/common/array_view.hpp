@@ -0,0 +1,51 @@
+#ifndef ARRAY_VIEW_H_
+#define ARRAY_VIEW_H_
+
+#include <cstddef>
+#include <type_traits>
+#include <valarray>
+#include <vector>
+
+using namespace std;
+
+/* Non-owning view of a contiguous array (pointer + length), the
+ * C++17 stand-in for std::span. Numerical kernels take their sample
+ * arrays as array_view<const T> so that valarrays, vectors and raw
+ * buffers can all be passed without a copy. */
+template<class T>
+class array_view {
+public:
+    using value_type = remove_cv_t<T>;
+
+    array_view() : ptr(nullptr), len(0) {}
+    array_view(T* data, size_t size) : ptr(data), len(size) {}
+
+    array_view(valarray<value_type>& v) : ptr(v.size() ? &v[0] : nullptr), len(v.size()) {}
+    template<class U = T, class = enable_if_t<is_const<U>::value> >
+    array_view(const valarray<value_type>& v) : ptr(v.size() ? &v[0] : nullptr), len(v.size()) {}
+
+    array_view(vector<value_type>& v) : ptr(v.data()), len(v.size()) {}
+    template<class U = T, class = enable_if_t<is_const<U>::value> >
+    array_view(const vector<value_type>& v) : ptr(v.data()), len(v.size()) {}
+
+    /* array_view<T> -> array_view<const T> */
+    template<class U, class = enable_if_t<is_same<const U, T>::value> >
+    array_view(const array_view<U>& v) : ptr(v.data()), len(v.size()) {}
+
+    T* data() const { return ptr; }
+    size_t size() const { return len; }
+    bool empty() const { return len == 0; }
+
+    T& operator[](size_t i) const { return ptr[i]; }
+    T* begin() const { return ptr; }
+    T* end() const { return ptr + len; }
+
+    /* Sub-view of count elements starting at offset */
+    array_view subview(size_t offset, size_t count) const { return array_view(ptr + offset, count); }
+
+private:
+    T* ptr;
+    size_t len;
+};
+
+#endif // ARRAY_VIEW_H_
@@ -0,0 +1,150 @@
+#ifndef BALL_FORCES_H_
+#define BALL_FORCES_H_
+
+#include <cmath>
+#include <string>
+#include <tuple>
+#include "q234.hpp"
+
+using namespace std;
+
+/* Force model of the ball as a compile-time list of terms.
+ *
+ * Each term carries its own parameters and adds its acceleration to
+ * a[3] given the velocity v[3]; ForceModel<Terms...> sums the terms
+ * into the right-hand side of the 6-state ODE (x, y, z, vx, vy, vz).
+ * Which terms are present is fixed by the type, so every physics
+ * configuration compiles to its own branch-free, fully inlined rhs,
+ * while the parameters travel with the model object and can differ
+ * per simulation and per thread. The terms are templated on the
+ * scalar type, so the same model also runs on double states, and the
+ * parameter types on theirs, so with Dual parameters (dual.hpp) the
+ * model carries derivatives with respect to C_DRAG or the spin. */
+
+struct Gravity {
+    double g = A_GRAV;
+
+    static constexpr const char* tag = "";
+
+    template<class T>
+    void add(const T v[3], T a[3]) const {
+        (void)v;
+        a[2] -= T(g);
+    }
+};
+
+/* Quadratic drag: a = -k |v| v with k = C_d rho A / (2 m) */
+template<class P = double>
+struct DragParamsOf {
+    P c_drag = P(C_DRAG);
+    double rho = RHO_AIR;
+    double radius = R_BALL;
+    double mass = M_BALL;
+
+    P coefficient() const { return P(0.5 * rho * M_PI * radius * radius / mass) * c_drag; }
+};
+
+typedef DragParamsOf<> DragParams;
+
+template<class Params = DragParams>
+struct Drag {
+    Params params;
+
+    static constexpr const char* tag = "_drag";
+
+    template<class T>
+    void add(const T v[3], T a[3]) const {
+        using std::sqrt;
+        T k = T(params.coefficient()) * sqrt(v[0] * v[0] + v[1] * v[1] + v[2] * v[2]);
+        for (int i = 0; i < 3; ++i) a[i] -= k * v[i];
+    }
+};
+
+/* Spin vectors for the Magnus term. Both give v x omega, the sign
+ * convention of the original rhs() in q4.cpp. SpinZ is the spin about
+ * the vertical axis only and drops the terms that are identically 0. */
+template<class P = double>
+struct SpinZOf {
+    P wz = P(0);
+
+    template<class T>
+    void v_cross(const T v[3], T out[3]) const {
+        out[0] = v[1] * T(wz);
+        out[1] = -v[0] * T(wz);
+        out[2] = T(0);
+    }
+};
+
+typedef SpinZOf<> SpinZ;
+
+template<class P = double>
+struct SpinVectorOf {
+    P w[3] = {P(0), P(0), P(0)};
+
+    template<class T>
+    void v_cross(const T v[3], T out[3]) const {
+        out[0] = v[1] * T(w[2]) - v[2] * T(w[1]);
+        out[1] = v[2] * T(w[0]) - v[0] * T(w[2]);
+        out[2] = v[0] * T(w[1]) - v[1] * T(w[0]);
+    }
+};
+
+typedef SpinVectorOf<> SpinVector;
+
+/* Magnus lift: a = (S / m) v x omega */
+template<class SpinVec = SpinZ>
+struct Magnus {
+    SpinVec spin;
+    double s_magn = S_MAGN;
+    double mass = M_BALL;
+
+    static constexpr const char* tag = "_magnus";
+
+    template<class T>
+    void add(const T v[3], T a[3]) const {
+        T c[3];
+        spin.v_cross(v, c);
+        T k = T(s_magn / mass);
+        for (int i = 0; i < 3; ++i) a[i] += k * c[i];
+    }
+};
+
+template<class... Terms>
+struct ForceModel {
+    tuple<Terms...> terms;
+
+    /* Sum of the term accelerations at velocity v; T is any type the
+     * terms can do arithmetic on (float, double, Dual, a SIMD lane
+     * block as in ensemble.cpp) */
+    template<class T>
+    void acceleration(const T v[3], T a[3]) const {
+        a[0] = a[1] = a[2] = T(0);
+        apply([&](const Terms&... term) { (term.add(v, a), ...); }, terms);
+    }
+
+    /* rhs(t, Y, dY) in the form of rk4_step() and DormandPrince45 */
+    template<class State>
+    void operator()(typename State::value_type t, const State& Y, State& dY) const {
+        using T = typename State::value_type;
+        (void)t;
+        T v[3] = {Y[3], Y[4], Y[5]};
+        T a[3];
+        acceleration(v, a);
+        dY[0] = v[0];
+        dY[1] = v[1];
+        dY[2] = v[2];
+        dY[3] = a[0];
+        dY[4] = a[1];
+        dY[5] = a[2];
+    }
+
+    /* Concatenated term tags, e.g. "_drag_magnus" for output file names */
+    static string tag() { return (string() + ... + string(Terms::tag)); }
+};
+
+template<class... Terms>
+ForceModel<Terms...> make_force_model(Terms... terms) {
+    return ForceModel<Terms...>{tuple<Terms...>(terms...)};
+}
+
+#endif // BALL_FORCES_H_
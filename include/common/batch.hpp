@@ -0,0 +1,72 @@
+#ifndef BATCH_H_
+#define BATCH_H_
+
+#include <condition_variable>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+/* Per-match results of the batch pipeline
+ * (tracking positions -> speed -> metabolic power -> energy) */
+struct MatchSummary {
+    string input;          // tracking file that was processed
+    bool ok = false;       // false if the file could not be processed
+    string error;          // reason when ok == false
+
+    size_t frames = 0;     // number of tracking frames
+    float duration = 0.0f; // covered time span in s
+    float distance = 0.0f; // distance covered in m
+    float max_speed = 0.0f;  // m/s
+    float mean_speed = 0.0f; // m/s
+    float energy = 0.0f;   // energy spent in J
+};
+
+/* Blocking byte budget that bounds how much input is held in memory
+ * by jobs in flight. A request larger than the whole capacity is let
+ * through once nothing else is in flight, so it cannot stall forever. */
+class MemoryBudget {
+public:
+    explicit MemoryBudget(size_t capacity_bytes) : capacity(capacity_bytes) {}
+
+    void acquire(size_t bytes) {
+        unique_lock<mutex> lock(m);
+        freed.wait(lock, [&] { return used == 0 || used + bytes <= capacity; });
+        used += bytes;
+    }
+
+    void release(size_t bytes) {
+        {
+            lock_guard<mutex> lock(m);
+            used -= bytes;
+        }
+        freed.notify_all();
+    }
+
+private:
+    size_t capacity;
+    size_t used = 0;
+    mutex m;
+    condition_variable freed;
+};
+
+/* Expand a directory (all *.dat files, sorted) or a manifest file
+ * (one path per line, '#' starts a comment, relative paths are taken
+ * relative to the manifest) into a list of tracking files */
+vector<string> collect_match_files(const string& path);
+
+/* Process one tracking file and write <outdir>/<name>_speed.dat */
+MatchSummary process_match_file(const string& input, const string& outdir);
+
+/* Process all inputs on a work-stealing pool of nthreads workers
+ * (0 = hardware concurrency), keeping the estimated memory of the
+ * jobs in flight below max_inflight_bytes. Results keep input order. */
+vector<MatchSummary> run_batch(const vector<string>& inputs, const string& outdir,
+                               size_t nthreads, size_t max_inflight_bytes);
+
+/* Write the per-file table followed by the aggregate totals */
+void write_batch_summary(const string& filename, const vector<MatchSummary>& results);
+
+#endif // BATCH_H_
@@ -0,0 +1,260 @@
+#ifndef BUTCHER_H_
+#define BUTCHER_H_
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+
+using namespace std;
+
+/* Fixed-step Runge-Kutta methods given by compile-time Butcher tableaux.
+ *
+ * A method is a struct with the tableau as static constexpr arrays
+ *   c[S], a[S][S], b[S]
+ * plus `stages`, `order` and `name`, deriving from ExplicitRK<> or
+ * ImplicitRK<> for its step():
+ *
+ *   int Method::step(rhs, t, y, h)   advance y in place, return the
+ *                                    number of rhs() calls made
+ *
+ * with the State and rhs(t, y, dydt) conventions of rk4_step() (see
+ * rk4.hpp). Stage vectors live on the stack, the stage loops have
+ * compile-time trip counts, and the zero entries of a sparse tableau
+ * are skipped at compile time. The symplectic splitting methods in
+ * symplectic.hpp share the same interface, so ode_steps<Method>() and
+ * plan_fixed_steps<Method>() below work for all of them.
+ *
+ * A method of order p and S stages costs S * (t1 - t0) / h rhs calls
+ * for an error of about C h^p: for a target accuracy the higher-order
+ * tableaux usually reach it with far fewer calls than RK4 with a
+ * smaller dt. plan_fixed_steps() measures this for a given problem. */
+
+/* Explicit methods: a[i][j] = 0 for j >= i */
+template<class Method>
+struct ExplicitRK {
+    template<class State, class RHS>
+    static int step(RHS&& rhs, typename State::value_type t, State& y, typename State::value_type h) {
+        using T = typename State::value_type;
+        constexpr int S = Method::stages;
+        const size_t n = y.size();
+        array<State, S> k;
+        State ytmp;
+
+        rhs(t, y, k[0]);
+        for (int i = 1; i < S; ++i) {
+            ytmp = y;
+            for (int j = 0; j < i; ++j) {
+                if (Method::a[i][j] == 0.0) continue;
+                const T ha = h * T(Method::a[i][j]);
+                for (size_t m = 0; m < n; ++m) ytmp[m] += ha * k[j][m];
+            }
+            rhs(t + h * T(Method::c[i]), ytmp, k[i]);
+        }
+        for (int j = 0; j < S; ++j) {
+            if (Method::b[j] == 0.0) continue;
+            const T hb = h * T(Method::b[j]);
+            for (size_t m = 0; m < n; ++m) y[m] += hb * k[j][m];
+        }
+        return S;
+    }
+};
+
+/* Implicit (collocation) methods: the stage equations
+ *   k_i = f(t + c_i h, y + h sum_j a_ij k_j)
+ * are solved by fixed-point iteration from k_i = f(t, y), which
+ * converges for h L |A| < 1, i.e. for the non-stiff problems of this
+ * library, until the stage update is at rounding level. */
+template<class Method>
+struct ImplicitRK {
+    static constexpr int max_iterations = 50;
+
+    template<class State, class RHS>
+    static int step(RHS&& rhs, typename State::value_type t, State& y, typename State::value_type h) {
+        using T = typename State::value_type;
+        constexpr int S = Method::stages;
+        const size_t n = y.size();
+        array<State, S> k;
+        State ytmp, knew;
+
+        rhs(t, y, k[0]);
+        int evaluations = 1;
+        for (int i = 1; i < S; ++i) k[i] = k[0];
+
+        T scale = T(0);
+        for (size_t m = 0; m < n; ++m) scale = max(scale, T(fabs(y[m])));
+        const T tol = T(4) * numeric_limits<T>::epsilon() * (T(1) + scale);
+
+        for (int it = 0; it < max_iterations; ++it) {
+            T change = T(0);
+            for (int i = 0; i < S; ++i) {
+                ytmp = y;
+                for (int j = 0; j < S; ++j) {
+                    const T ha = h * T(Method::a[i][j]);
+                    for (size_t m = 0; m < n; ++m) ytmp[m] += ha * k[j][m];
+                }
+                rhs(t + h * T(Method::c[i]), ytmp, knew);
+                for (size_t m = 0; m < n; ++m) change = max(change, T(fabs(h * (knew[m] - k[i][m]))));
+                k[i] = knew;
+            }
+            evaluations += S;
+            if (change <= tol) break;
+        }
+
+        for (int j = 0; j < S; ++j) {
+            const T hb = h * T(Method::b[j]);
+            for (size_t m = 0; m < n; ++m) y[m] += hb * k[j][m];
+        }
+        return evaluations;
+    }
+};
+
+/* Classical RK4 (the method of rk4_step()) */
+struct ClassicRK4 : ExplicitRK<ClassicRK4> {
+    static constexpr int stages = 4, order = 4;
+    static constexpr const char* name = "rk4";
+    static constexpr double c[4] = {0.0, 0.5, 0.5, 1.0};
+    static constexpr double a[4][4] = {
+        {0.0, 0.0, 0.0, 0.0}, {0.5, 0.0, 0.0, 0.0}, {0.0, 0.5, 0.0, 0.0}, {0.0, 0.0, 1.0, 0.0}};
+    static constexpr double b[4] = {1.0 / 6.0, 1.0 / 3.0, 1.0 / 3.0, 1.0 / 6.0};
+};
+
+/* Butcher's 7-stage sixth-order method (Butcher 1964) */
+struct ButcherRK6 : ExplicitRK<ButcherRK6> {
+    static constexpr int stages = 7, order = 6;
+    static constexpr const char* name = "rk6";
+    static constexpr double c[7] = {0.0, 1.0 / 3.0, 2.0 / 3.0, 1.0 / 3.0, 0.5, 0.5, 1.0};
+    static constexpr double a[7][7] = {
+        {0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0},
+        {1.0 / 3.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0},
+        {0.0, 2.0 / 3.0, 0.0, 0.0, 0.0, 0.0, 0.0},
+        {1.0 / 12.0, 1.0 / 3.0, -1.0 / 12.0, 0.0, 0.0, 0.0, 0.0},
+        {-1.0 / 16.0, 9.0 / 8.0, -3.0 / 16.0, -3.0 / 8.0, 0.0, 0.0, 0.0},
+        {0.0, 9.0 / 8.0, -3.0 / 8.0, -3.0 / 4.0, 0.5, 0.0, 0.0},
+        {9.0 / 44.0, -9.0 / 11.0, 63.0 / 44.0, 18.0 / 11.0, 0.0, -16.0 / 11.0, 0.0}};
+    static constexpr double b[7] = {11.0 / 120.0, 0.0, 27.0 / 40.0, 27.0 / 40.0, -4.0 / 15.0, -4.0 / 15.0, 11.0 / 120.0};
+};
+
+/* Cooper-Verner 11-stage eighth-order method (Cooper & Verner 1972);
+ * s = sqrt(21) */
+struct CooperVerner8 : ExplicitRK<CooperVerner8> {
+    static constexpr int stages = 11, order = 8;
+    static constexpr const char* name = "rk8";
+    static constexpr double s = 4.582575694955840006588047193728;
+    static constexpr double c[11] = {0.0, 0.5, 0.5, (7.0 + s) / 14.0, (7.0 + s) / 14.0, 0.5,
+                                     (7.0 - s) / 14.0, (7.0 - s) / 14.0, 0.5, (7.0 + s) / 14.0, 1.0};
+    static constexpr double a[11][11] = {
+        {0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0},
+        {0.5, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0},
+        {0.25, 0.25, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0},
+        {1.0 / 7.0, (-7.0 - 3.0 * s) / 98.0, (21.0 + 5.0 * s) / 49.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0},
+        {(11.0 + s) / 84.0, 0.0, (18.0 + 4.0 * s) / 63.0, (21.0 - s) / 252.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0},
+        {(5.0 + s) / 48.0, 0.0, (9.0 + s) / 36.0, (-231.0 + 14.0 * s) / 360.0, (63.0 - 7.0 * s) / 80.0, 0.0, 0.0,
+         0.0, 0.0, 0.0, 0.0},
+        {(10.0 - s) / 42.0, 0.0, (-432.0 + 92.0 * s) / 315.0, (633.0 - 145.0 * s) / 90.0,
+         (-504.0 + 115.0 * s) / 70.0, (63.0 - 13.0 * s) / 35.0, 0.0, 0.0, 0.0, 0.0, 0.0},
+        {1.0 / 14.0, 0.0, 0.0, 0.0, (14.0 - 3.0 * s) / 126.0, (13.0 - 3.0 * s) / 63.0, 1.0 / 9.0, 0.0, 0.0, 0.0,
+         0.0},
+        {1.0 / 32.0, 0.0, 0.0, 0.0, (91.0 - 21.0 * s) / 576.0, 11.0 / 72.0, (-385.0 - 75.0 * s) / 1152.0,
+         (63.0 + 13.0 * s) / 128.0, 0.0, 0.0, 0.0},
+        {1.0 / 14.0, 0.0, 0.0, 0.0, 1.0 / 9.0, (-733.0 - 147.0 * s) / 2205.0, (515.0 + 111.0 * s) / 504.0,
+         (-51.0 - 11.0 * s) / 56.0, (132.0 + 28.0 * s) / 245.0, 0.0, 0.0},
+        {0.0, 0.0, 0.0, 0.0, (-42.0 + 7.0 * s) / 18.0, (-18.0 + 28.0 * s) / 45.0, (-273.0 - 53.0 * s) / 72.0,
+         (301.0 + 53.0 * s) / 72.0, (28.0 - 28.0 * s) / 45.0, (49.0 - 7.0 * s) / 18.0, 0.0}};
+    static constexpr double b[11] = {1.0 / 20.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 49.0 / 180.0, 16.0 / 45.0,
+                                     49.0 / 180.0, 1.0 / 20.0};
+};
+
+/* Two-stage Gauss-Legendre collocation, order 4; r = sqrt(3) / 6 */
+struct GaussLegendreRK4 : ImplicitRK<GaussLegendreRK4> {
+    static constexpr int stages = 2, order = 4;
+    static constexpr const char* name = "gl4";
+    static constexpr double r = 0.288675134594812882254574390251;
+    static constexpr double c[2] = {0.5 - r, 0.5 + r};
+    static constexpr double a[2][2] = {{0.25, 0.25 - r}, {0.25 + r, 0.25}};
+    static constexpr double b[2] = {0.5, 0.5};
+};
+
+/* Three-stage Gauss-Legendre collocation, order 6; r = sqrt(15) */
+struct GaussLegendreRK6 : ImplicitRK<GaussLegendreRK6> {
+    static constexpr int stages = 3, order = 6;
+    static constexpr const char* name = "gl6";
+    static constexpr double r = 3.872983346207416885179265399782;
+    static constexpr double c[3] = {0.5 - r / 10.0, 0.5, 0.5 + r / 10.0};
+    static constexpr double a[3][3] = {{5.0 / 36.0, 2.0 / 9.0 - r / 15.0, 5.0 / 36.0 - r / 30.0},
+                                       {5.0 / 36.0 + r / 24.0, 2.0 / 9.0, 5.0 / 36.0 - r / 24.0},
+                                       {5.0 / 36.0 + r / 30.0, 2.0 / 9.0 + r / 15.0, 5.0 / 36.0}};
+    static constexpr double b[3] = {5.0 / 18.0, 4.0 / 9.0, 5.0 / 18.0};
+};
+
+/* N steps of size h from (t0, y) with any method of this family; y is
+ * advanced in place and the number of rhs() calls is returned */
+template<class Method, class State, class RHS>
+long ode_steps(RHS&& rhs, typename State::value_type t0, State& y, typename State::value_type h, int N) {
+    using T = typename State::value_type;
+    long evaluations = 0;
+    for (int i = 0; i < N; ++i) evaluations += Method::step(rhs, t0 + T(i) * h, y, h);
+    return evaluations;
+}
+
+/* Fixed step count that meets an accuracy target on [t0, t1] */
+struct StepPlan {
+    int steps = 0;              // steps over [t0, t1]
+    double h = 0.0;
+    double error = 0.0;         // estimated max-norm error of y(t1)
+    double order = 0.0;         // observed order of convergence
+    long evaluations = 0;       // rhs() calls of one run with this plan
+    bool converged = false;
+};
+
+/* Double the step count, starting from one step, until the estimated
+ * error of y(t1) is below tol. The error of the run with 2N steps is
+ * estimated from the run with N steps by Richardson's argument,
+ * |y_2N - y_N| / (2^p - 1), with the order p observed from the last
+ * three runs, p = log2(|y_N - y_N/2| / |y_2N - y_N|), capped at the
+ * method's nominal order. The nominal order alone would be optimistic
+ * where a method loses order on this problem, e.g. the splitting
+ * methods with velocity-dependent forces. Plans of different methods
+ * for the same problem show which one needs the fewest rhs() calls. */
+template<class Method, class State, class RHS>
+StepPlan plan_fixed_steps(RHS&& rhs, typename State::value_type t0, const State& y0,
+                          typename State::value_type t1, double tol, int max_steps = 1 << 16) {
+    using T = typename State::value_type;
+    StepPlan plan;
+    State prev = y0;
+    ode_steps<Method>(rhs, t0, prev, t1 - t0, 1);
+    double diff_prev = -1.0;
+    for (int n = 2; n <= max_steps; n *= 2) {
+        State y = y0;
+        T h = (t1 - t0) / T(n);
+        long evaluations = ode_steps<Method>(rhs, t0, y, h, n);
+        double diff = 0.0;
+        for (size_t m = 0; m < y.size(); ++m) diff = max(diff, double(fabs(y[m] - prev[m])));
+        plan.steps = n;
+        plan.h = double(h);
+        plan.evaluations = evaluations;
+        if (diff == 0.0) {
+            plan.order = double(Method::order);
+            plan.error = 0.0;
+            plan.converged = true;
+            break;
+        }
+        if (diff_prev > 0.0) {
+            double p = min(max(log2(diff_prev / diff), 0.25), double(Method::order));
+            plan.order = p;
+            plan.error = diff / (pow(2.0, p) - 1.0);
+            if (plan.error <= tol) {
+                plan.converged = true;
+                break;
+            }
+        } else {
+            plan.error = diff;  // no order estimate yet
+        }
+        diff_prev = diff;
+        prev = y;
+    }
+    return plan;
+}
+
+#endif // BUTCHER_H_
@@ -0,0 +1,222 @@
+#ifndef DOPRI45_H_
+#define DOPRI45_H_
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+
+using namespace std;
+
+/* Dormand-Prince 5(4) coefficients (Hairer, Norsett & Wanner, DOPRI5):
+ * stages c/a, 5th-order weights b = a7* (the last stage is evaluated
+ * at the new point, so it is the first stage of the next step: FSAL),
+ * error weights e = b - b*, and the dense-output weights d. */
+struct DoPri5 {
+    static constexpr double c2 = 1.0 / 5.0, c3 = 3.0 / 10.0, c4 = 4.0 / 5.0, c5 = 8.0 / 9.0;
+    static constexpr double a21 = 1.0 / 5.0;
+    static constexpr double a31 = 3.0 / 40.0, a32 = 9.0 / 40.0;
+    static constexpr double a41 = 44.0 / 45.0, a42 = -56.0 / 15.0, a43 = 32.0 / 9.0;
+    static constexpr double a51 = 19372.0 / 6561.0, a52 = -25360.0 / 2187.0, a53 = 64448.0 / 6561.0,
+                            a54 = -212.0 / 729.0;
+    static constexpr double a61 = 9017.0 / 3168.0, a62 = -355.0 / 33.0, a63 = 46732.0 / 5247.0,
+                            a64 = 49.0 / 176.0, a65 = -5103.0 / 18656.0;
+    static constexpr double a71 = 35.0 / 384.0, a73 = 500.0 / 1113.0, a74 = 125.0 / 192.0,
+                            a75 = -2187.0 / 6784.0, a76 = 11.0 / 84.0;
+    static constexpr double e1 = 71.0 / 57600.0, e3 = -71.0 / 16695.0, e4 = 71.0 / 1920.0,
+                            e5 = -17253.0 / 339200.0, e6 = 22.0 / 525.0, e7 = -1.0 / 40.0;
+    static constexpr double d1 = -12715105075.0 / 11282082432.0, d3 = 87487479700.0 / 32700410799.0,
+                            d4 = -10690763975.0 / 1880347072.0, d5 = 701980252875.0 / 199316789632.0,
+                            d6 = -1453857185.0 / 822651844.0, d7 = 69997945.0 / 29380423.0;
+};
+
+/* Tolerances and step limits; h0 = 0 picks the first step size
+ * automatically, h_max = 0 means no limit */
+struct DoPriOptions {
+    double abs_tol = 1e-6;
+    double rel_tol = 1e-6;
+    double h0 = 0.0;
+    double h_max = 0.0;
+    size_t max_steps = 100000;
+};
+
+/* Adaptive Dormand-Prince RK45 for fixed-size states (same State and
+ * rhs(t, y, dydt) conventions as rk4_step(), see rk4.hpp).
+ *
+ * Each step() advances by one accepted step, retrying rejected ones.
+ * The local error is measured in the RMS norm of err_i / (abs_tol +
+ * rel_tol * max(|y_i|, |y_new_i|)); the next step size comes from the
+ * PI controller h_new = h * 0.9 err^-0.17 err_prev^0.04, bounded to
+ * [h/5, 10 h], and never grows right after a rejection.
+ *
+ * dense(t, y) evaluates the 4th-order continuous extension anywhere in
+ * the last step from the stored stages, without calling rhs. */
+template<class State, class RHS>
+class DormandPrince45 {
+public:
+    using T = typename State::value_type;
+
+    DormandPrince45(RHS f, T t0, const State& y0, const DoPriOptions& options = DoPriOptions())
+        : rhs(f), opt(options), tc(t0), tp(t0), yc(y0), yp(y0) {
+        rhs(tc, yc, k1);
+        n_eval = 1;
+        h = (opt.h0 > 0.0) ? T(opt.h0) : initial_step();
+        if (opt.h_max > 0.0) h = min(h, T(opt.h_max));
+    }
+
+    /* One accepted step, not past t_end. Returns false once t_end is
+     * reached, if max_steps is exhausted or if h underflows. */
+    bool step(T t_end) {
+        if (tc >= t_end || n_accepted + n_rejected >= opt.max_steps) return false;
+        const size_t n = yc.size();
+        for (;;) {
+            bool last = false;
+            T hs = h;
+            if (tc + hs >= t_end) {
+                hs = t_end - tc;
+                last = true;
+            }
+            if (!(hs > T(0)) || tc + hs == tc) return false;
+
+            State ytmp;
+            for (size_t i = 0; i < n; ++i) ytmp[i] = yc[i] + hs * T(DoPri5::a21) * k1[i];
+            rhs(tc + T(DoPri5::c2) * hs, ytmp, k2);
+            for (size_t i = 0; i < n; ++i) ytmp[i] = yc[i] + hs * (T(DoPri5::a31) * k1[i] + T(DoPri5::a32) * k2[i]);
+            rhs(tc + T(DoPri5::c3) * hs, ytmp, k3);
+            for (size_t i = 0; i < n; ++i)
+                ytmp[i] = yc[i] + hs * (T(DoPri5::a41) * k1[i] + T(DoPri5::a42) * k2[i] + T(DoPri5::a43) * k3[i]);
+            rhs(tc + T(DoPri5::c4) * hs, ytmp, k4);
+            for (size_t i = 0; i < n; ++i)
+                ytmp[i] = yc[i] + hs * (T(DoPri5::a51) * k1[i] + T(DoPri5::a52) * k2[i] + T(DoPri5::a53) * k3[i] +
+                                        T(DoPri5::a54) * k4[i]);
+            rhs(tc + T(DoPri5::c5) * hs, ytmp, k5);
+            for (size_t i = 0; i < n; ++i)
+                ytmp[i] = yc[i] + hs * (T(DoPri5::a61) * k1[i] + T(DoPri5::a62) * k2[i] + T(DoPri5::a63) * k3[i] +
+                                        T(DoPri5::a64) * k4[i] + T(DoPri5::a65) * k5[i]);
+            T tn = last ? t_end : tc + hs;
+            rhs(tn, ytmp, k6);
+            State yn;
+            for (size_t i = 0; i < n; ++i)
+                yn[i] = yc[i] + hs * (T(DoPri5::a71) * k1[i] + T(DoPri5::a73) * k3[i] + T(DoPri5::a74) * k4[i] +
+                                      T(DoPri5::a75) * k5[i] + T(DoPri5::a76) * k6[i]);
+            rhs(tn, yn, k7);
+            n_eval += 6;
+
+            double err = 0.0;
+            for (size_t i = 0; i < n; ++i) {
+                double e = double(hs) * (DoPri5::e1 * double(k1[i]) + DoPri5::e3 * double(k3[i]) +
+                                         DoPri5::e4 * double(k4[i]) + DoPri5::e5 * double(k5[i]) +
+                                         DoPri5::e6 * double(k6[i]) + DoPri5::e7 * double(k7[i]));
+                double sc = opt.abs_tol + opt.rel_tol * max(fabs(double(yc[i])), fabs(double(yn[i])));
+                err += (e / sc) * (e / sc);
+            }
+            err = sqrt(err / double(n));
+
+            /* PI step size controller */
+            double fac11 = pow(err, 0.17);
+            if (err <= 1.0) {
+                double fac = fac11 / pow(err_prev, 0.04) / 0.9;
+                fac = max(0.1, min(5.0, fac));
+                err_prev = max(err, 1e-4);
+
+                /* dense output: build the interpolant before the stages are reused */
+                for (size_t i = 0; i < n; ++i) {
+                    T ydiff = yn[i] - yc[i];
+                    T bspl = hs * k1[i] - ydiff;
+                    r1[i] = yc[i];
+                    r2[i] = ydiff;
+                    r3[i] = bspl;
+                    r4[i] = ydiff - hs * k7[i] - bspl;
+                    r5[i] = hs * (T(DoPri5::d1) * k1[i] + T(DoPri5::d3) * k3[i] + T(DoPri5::d4) * k4[i] +
+                                  T(DoPri5::d5) * k5[i] + T(DoPri5::d6) * k6[i] + T(DoPri5::d7) * k7[i]);
+                }
+
+                tp = tc;
+                yp = yc;
+                tc = tn;
+                yc = yn;
+                k1 = k7;   // FSAL
+                hl = hs;
+                T hn = T(double(hs) / fac);
+                if (rejected_last) hn = min(hn, hs);
+                if (opt.h_max > 0.0) hn = min(hn, T(opt.h_max));
+                if (!last || hn > h) h = hn;
+                rejected_last = false;
+                n_accepted++;
+                return true;
+            }
+
+            h = T(double(hs) / min(5.0, fac11 / 0.9));
+            rejected_last = true;
+            n_rejected++;
+            if (n_accepted + n_rejected >= opt.max_steps) return false;
+        }
+    }
+
+    /* State at time s in [t_prev(), t()] from the last accepted step */
+    void dense(T s, State& y) const {
+        T theta = (hl > T(0)) ? (s - tp) / hl : T(1);
+        T theta1 = T(1) - theta;
+        for (size_t i = 0; i < y.size(); ++i) {
+            y[i] = r1[i] + theta * (r2[i] + theta1 * (r3[i] + theta * (r4[i] + theta1 * r5[i])));
+        }
+    }
+
+    T t() const { return tc; }
+    T t_prev() const { return tp; }
+    const State& state() const { return yc; }
+    const State& state_prev() const { return yp; }
+    const State& derivative() const { return k1; }   // rhs(t(), state())
+    T step_size() const { return h; }
+    size_t evaluations() const { return n_eval; }
+    size_t accepted() const { return n_accepted; }
+    size_t rejected() const { return n_rejected; }
+
+private:
+    /* Starting step from the scale of y and y' and a trial Euler step */
+    T initial_step() {
+        const size_t n = yc.size();
+        double d0 = 0.0, d1 = 0.0;
+        for (size_t i = 0; i < n; ++i) {
+            double sc = opt.abs_tol + opt.rel_tol * fabs(double(yc[i]));
+            d0 += (double(yc[i]) / sc) * (double(yc[i]) / sc);
+            d1 += (double(k1[i]) / sc) * (double(k1[i]) / sc);
+        }
+        d0 = sqrt(d0 / double(n));
+        d1 = sqrt(d1 / double(n));
+        double h0 = (d0 < 1e-5 || d1 < 1e-5) ? 1e-6 : 0.01 * d0 / d1;
+
+        State y1, f1;
+        for (size_t i = 0; i < n; ++i) y1[i] = yc[i] + T(h0) * k1[i];
+        rhs(tc + T(h0), y1, f1);
+        n_eval++;
+        double d2 = 0.0;
+        for (size_t i = 0; i < n; ++i) {
+            double sc = opt.abs_tol + opt.rel_tol * fabs(double(yc[i]));
+            double df = (double(f1[i]) - double(k1[i])) / sc;
+            d2 += df * df;
+        }
+        d2 = sqrt(d2 / double(n)) / h0;
+        double dm = max(d1, d2);
+        double h1 = (dm <= 1e-15) ? max(1e-6, h0 * 1e-3) : pow(0.01 / dm, 0.2);
+        return T(min(100.0 * h0, h1));
+    }
+
+    RHS rhs;
+    DoPriOptions opt;
+    T tc, tp;
+    T h = T(0), hl = T(0);
+    State yc, yp;
+    State k1, k2, k3, k4, k5, k6, k7;
+    State r1, r2, r3, r4, r5;
+    double err_prev = 1e-4;
+    bool rejected_last = false;
+    size_t n_eval = 0, n_accepted = 0, n_rejected = 0;
+};
+
+template<class State, class RHS>
+DormandPrince45<State, RHS> make_dopri45(RHS f, typename State::value_type t0, const State& y0,
+                                         const DoPriOptions& options = DoPriOptions()) {
+    return DormandPrince45<State, RHS>(f, t0, y0, options);
+}
+
+#endif // DOPRI45_H_
@@ -0,0 +1,103 @@
+#ifndef DUAL_H_
+#define DUAL_H_
+
+#include <cmath>
+#include <type_traits>
+
+using namespace std;
+
+/* Forward-mode dual numbers with N derivative slots:
+ *   x = v + sum_k d[k] eps_k,   eps_j eps_k = 0
+ *
+ * Running a computation on Dual<N> instead of double carries the
+ * derivatives of every intermediate with respect to N seeded inputs
+ * (seed input k with variable(value, k)), exact to rounding and at the
+ * cost of about N+1 evaluations. N is a compile-time constant, so the
+ * slot loops are unrolled and a Dual is a plain array on the stack.
+ * Scalars convert implicitly, so code templated on its scalar type
+ * (rk4_step(), ForceModel, ...) runs unchanged; comparisons look at
+ * the value only. */
+template<int N, class T = double>
+struct Dual {
+    T v;
+    T d[N];
+
+    Dual() : v(0), d{} {}
+
+    template<class S, class = typename enable_if<is_arithmetic<S>::value>::type>
+    Dual(S value) : v(T(value)), d{} {}
+
+    /* Independent variable of slot k */
+    static Dual variable(T value, int k) {
+        Dual x(value);
+        x.d[k] = T(1);
+        return x;
+    }
+
+    Dual& operator+=(const Dual& b) {
+        v += b.v;
+        for (int k = 0; k < N; ++k) d[k] += b.d[k];
+        return *this;
+    }
+    Dual& operator-=(const Dual& b) {
+        v -= b.v;
+        for (int k = 0; k < N; ++k) d[k] -= b.d[k];
+        return *this;
+    }
+    Dual& operator*=(const Dual& b) { return *this = *this * b; }
+    Dual& operator/=(const Dual& b) { return *this = *this / b; }
+
+    friend Dual operator+(Dual a, const Dual& b) { return a += b; }
+    friend Dual operator-(Dual a, const Dual& b) { return a -= b; }
+    friend Dual operator-(const Dual& a) {
+        Dual r;
+        r.v = -a.v;
+        for (int k = 0; k < N; ++k) r.d[k] = -a.d[k];
+        return r;
+    }
+    friend Dual operator+(const Dual& a) { return a; }
+
+    friend Dual operator*(const Dual& a, const Dual& b) {
+        Dual r;
+        r.v = a.v * b.v;
+        for (int k = 0; k < N; ++k) r.d[k] = a.d[k] * b.v + a.v * b.d[k];
+        return r;
+    }
+
+    friend Dual operator/(const Dual& a, const Dual& b) {
+        Dual r;
+        T inv = T(1) / b.v;
+        r.v = a.v * inv;
+        for (int k = 0; k < N; ++k) r.d[k] = (a.d[k] - r.v * b.d[k]) * inv;
+        return r;
+    }
+
+    friend bool operator<(const Dual& a, const Dual& b) { return a.v < b.v; }
+    friend bool operator>(const Dual& a, const Dual& b) { return a.v > b.v; }
+    friend bool operator<=(const Dual& a, const Dual& b) { return a.v <= b.v; }
+    friend bool operator>=(const Dual& a, const Dual& b) { return a.v >= b.v; }
+    friend bool operator==(const Dual& a, const Dual& b) { return a.v == b.v; }
+    friend bool operator!=(const Dual& a, const Dual& b) { return a.v != b.v; }
+
+    /* f(a) with f(a.v) = fv and f'(a.v) = dfv */
+    static Dual chain(const Dual& a, T fv, T dfv) {
+        Dual r;
+        r.v = fv;
+        for (int k = 0; k < N; ++k) r.d[k] = dfv * a.d[k];
+        return r;
+    }
+
+    friend Dual sqrt(const Dual& a) {
+        T s = std::sqrt(a.v);
+        return chain(a, s, s > T(0) ? T(0.5) / s : T(0));
+    }
+    friend Dual sin(const Dual& a) { return chain(a, std::sin(a.v), std::cos(a.v)); }
+    friend Dual cos(const Dual& a) { return chain(a, std::cos(a.v), -std::sin(a.v)); }
+    friend Dual exp(const Dual& a) {
+        T e = std::exp(a.v);
+        return chain(a, e, e);
+    }
+    friend Dual fabs(const Dual& a) { return a.v < T(0) ? -a : a; }
+};
+
+#endif // DUAL_H_
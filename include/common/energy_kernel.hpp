@@ -0,0 +1,108 @@
+#ifndef ENERGY_KERNEL_H_
+#define ENERGY_KERNEL_H_
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <valarray>
+#include <vector>
+#include "array_view.hpp"
+#include "interp.hpp"
+#include "newton_cotes.hpp"
+
+using namespace std;
+
+/* Fused interpolate-and-integrate kernels for the energy
+ * E = int P(v(t)) dt.
+ *
+ * Instead of filling an array p_i = P(v_i) and integrating it in a
+ * second pass, the power model is passed as the sample map of the
+ * Newton-Cotes kernel, so P(v_i) is evaluated and weighted while the
+ * speed samples stream past. There is no n-sized intermediate and
+ * the speed column is read once. */
+
+/* Interpolating polynomial of a power table with N points, in Newton
+ * form (coefficients from interp_coeffs()). It is the same polynomial
+ * as Lagrange_N() on the table, evaluated in O(N) with a nested
+ * product whose trip count is fixed at compile time. */
+template<int N>
+struct PowerPolynomial {
+    double c[N];
+    double xn[N];
+
+    PowerPolynomial(const valarray<float>& v_table, const valarray<float>& P_table) {
+        assert(v_table.size() == size_t(N) && P_table.size() == size_t(N));
+        valarray<float> coeffs = interp_coeffs(v_table, P_table);
+        for (int i = 0; i < N; ++i) {
+            c[i] = double(coeffs[size_t(i)]);
+            xn[i] = double(v_table[size_t(i)]);
+        }
+    }
+
+    double operator()(float v) const {
+        double x = double(v);
+        double result = c[N - 1];
+        for (int i = N - 2; i >= 0; --i) result = result * (x - xn[i]) + c[i];
+        return result;
+    }
+};
+
+/* Lookup table of any power model on a uniform speed grid, linearly
+ * interpolated between bins and clamped at the ends */
+class PowerLUT {
+public:
+    template<class Model>
+    PowerLUT(const Model& model, float v_min, float v_max, size_t bins)
+        : v0(v_min), inv_dv(double(bins) / (double(v_max) - double(v_min))), table(bins + 1) {
+        double dv = (double(v_max) - double(v_min)) / double(bins);
+        for (size_t i = 0; i <= bins; ++i) table[i] = double(model(float(double(v_min) + double(i) * dv)));
+    }
+
+    double operator()(float v) const {
+        double x = (double(v) - double(v0)) * inv_dv;
+        size_t last = table.size() - 1;
+        if (x <= 0.0) return table[0];
+        if (x >= double(last)) return table[last];
+        size_t i = size_t(x);
+        double w = x - double(i);
+        return (1.0 - w) * table[i] + w * table[i + 1];
+    }
+
+private:
+    float v0;
+    double inv_dv;
+    vector<double> table;
+};
+
+/* Power-speed curve of Q3(a): cubic through (v, P) =
+ * (0, 100), (3, 700), (5, 1100), (8, 2000) in (m/s, W) */
+inline PowerPolynomial<4> player_power_curve() {
+    valarray<float> v_table = {0.0f, 3.0f, 5.0f, 8.0f};
+    valarray<float> P_table = {100.0f, 700.0f, 1100.0f, 2000.0f};
+    return PowerPolynomial<4>(v_table, P_table);
+}
+
+/* E = int P(v(t)) dt over equally spaced speed samples (spacing h)
+ * with the composite NCpoints-point rule, in one fused pass */
+template<class Model>
+double integrate_power(array_view<const float> v, double h, const Model& power, int NCpoints = 2) {
+    return integrate_nc<float>(v, h, NCpoints, power);
+}
+
+/* Same for non-uniform timestamps t_i (trapezoid rule), written as
+ * per-sample weights: sample i carries (t_i+1 - t_i-1) / 2, the end
+ * samples half their one interval, so each P(v_i) is evaluated once */
+template<class Model>
+double integrate_power(array_view<const float> t, array_view<const float> v, const Model& power) {
+    size_t n = v.size();
+    if (n < 2) return 0.0;
+    const float* pt = t.data();
+    const float* pv = v.data();
+    return reduce_indexed(n, [pt, pv, n, &power](size_t i) {
+        double lo = double(pt[i > 0 ? i - 1 : 0]);
+        double hi = double(pt[i + 1 < n ? i + 1 : n - 1]);
+        return 0.5 * (hi - lo) * power(pv[i]);
+    });
+}
+
+#endif // ENERGY_KERNEL_H_
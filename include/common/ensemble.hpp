@@ -0,0 +1,79 @@
+#ifndef ENSEMBLE_H_
+#define ENSEMBLE_H_
+
+#include <cstddef>
+#include <vector>
+#include "thread_pool.hpp"
+
+using namespace std;
+
+/* Ensemble ballistics: many shots integrated in lockstep.
+ *
+ * Shots are packed ENSEMBLE_LANES at a time into structure-of-arrays
+ * batches (one float array per state component), so the RK4 stages
+ * and the force terms of ball_forces.hpp are straight loops over the
+ * lanes that the compiler turns into SIMD code (16 floats = two AVX or
+ * one AVX-512 register). Each BallPhysics configuration selects its
+ * ForceModel once per batch, with per-lane drag and spin parameters,
+ * so the lane loop has no physics branches. A lane whose shot has
+ * reached the goal line or the ground is masked out and keeps its
+ * crossing state; the batch stops when every lane is done. Crossings
+ * are located on the cubic Hermite interpolant of the step, as in
+ * ode_events.hpp, from the derivatives RK4 already computes, so no
+ * extra rhs calls are needed. */
+
+/* Lanes of a batch: one 64-byte vector per state component, i.e.
+ * 16 float or 8 double lanes */
+template<class T>
+constexpr size_t ensemble_lanes = 64 / sizeof(T);
+
+const size_t ENSEMBLE_LANES = ensemble_lanes<float>;
+
+/* Launch conditions of one shot: position (ball centre), speed,
+ * elevation and azimuth in rad (azimuth 0 = straight towards the
+ * goal, +x), spin about the vertical axis in rad/s, and the drag
+ * coefficient as a multiple of C_DRAG */
+struct ShotLaunch {
+    float x, y, z;
+    float speed, elevation, azimuth;
+    float spin_z;
+    float drag_scale = 1.0f;
+};
+
+/* Force model switches and coefficients (see q234.hpp) */
+struct BallPhysics {
+    bool drag = true;
+    bool magnus = true;
+};
+
+enum class ShotOutcome : unsigned char { Good, Over, Weak, Unresolved };
+
+/* Outcome and state at the terminating crossing (goal line or ground);
+ * Unresolved if neither happened within T_FLIGHT_MAX */
+struct ShotResult {
+    ShotOutcome outcome = ShotOutcome::Unresolved;
+    float t = 0.0f;
+    float x = 0.0f, y = 0.0f, z = 0.0f;
+    float vx = 0.0f, vy = 0.0f, vz = 0.0f;
+};
+
+/* Integrate all shots with fixed RK4 steps dt, one batch of
+ * ENSEMBLE_LANES shots per task on the pool. Results keep input order. */
+vector<ShotResult> simulate_shots(const vector<ShotLaunch>& shots, float dt, const BallPhysics& physics,
+                                  ThreadPool& pool);
+
+/* Serial form, for callers that parallelise at a higher level */
+vector<ShotResult> simulate_shots(const vector<ShotLaunch>& shots, float dt, const BallPhysics& physics);
+
+/* The same integration in scalar type T, e.g. simulate_shots<double>()
+ * with ensemble_lanes<double> = 8 lanes to validate float runs; the
+ * forms above are T = float. Instantiated for float and double. */
+template<class T>
+vector<ShotResult> simulate_shots(const vector<ShotLaunch>& shots, float dt, const BallPhysics& physics,
+                                  ThreadPool& pool);
+template<class T>
+vector<ShotResult> simulate_shots(const vector<ShotLaunch>& shots, float dt, const BallPhysics& physics);
+
+const char* shot_outcome_name(ShotOutcome outcome);
+
+#endif // ENSEMBLE_H_
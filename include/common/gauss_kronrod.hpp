@@ -0,0 +1,212 @@
+#ifndef GAUSS_KRONROD_H_
+#define GAUSS_KRONROD_H_
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstddef>
+#include <vector>
+#include "quad_result.hpp"
+
+using namespace std;
+
+/* 15-point Kronrod extension of the 7-point Gauss rule on [-1, 1]
+ * (QUADPACK qk15). Nodes are +-xgk[k]; the Gauss nodes are the odd
+ * entries xgk[1], xgk[3], xgk[5] and the centre xgk[7] = 0. */
+struct GK15 {
+    static constexpr double xgk[8] = {
+        0.991455371120812639206854697526329, 0.949107912342758524526189684047851,
+        0.864864423359769072789712788640926, 0.741531185599394439863864773280788,
+        0.586087235467691130294144845693013, 0.405845151377397166906606412076961,
+        0.207784955007898467600689403773245, 0.000000000000000000000000000000000};
+    static constexpr double wgk[8] = {
+        0.022935322010529224963732008058970, 0.063092092629978553290700663189204,
+        0.104790010322250183839876322541518, 0.140653259715525918745189590510238,
+        0.169004726639267902826583426598550, 0.190350578064785409913256402421014,
+        0.204432940075298892414161999234649, 0.209482141084727828012999174891714};
+    static constexpr double wg[4] = {
+        0.129484966168869693270611432679082, 0.279705391489276667901467771423780,
+        0.381830050505118944950369775488975, 0.417959183673469387755102040816327};
+};
+
+/* Adapter that turns a scalar callable double(double) into the batch
+ * form void(const double* x, double* fx, size_t n) */
+template<class F>
+struct BatchedIntegrand {
+    F f;
+    void operator()(const double* x, double* fx, size_t n) const {
+        for (size_t i = 0; i < n; ++i) fx[i] = f(x[i]);
+    }
+};
+
+template<class F>
+BatchedIntegrand<F> batched(F f) { return BatchedIntegrand<F>{f}; }
+
+/* Adaptive G7K15 integrator over [a, b].
+ *
+ * The partition is kept in a max-heap ordered by error estimate;
+ * each refinement bisects the worst subintervals and evaluates the
+ * 15 nodes of both halves in one call of the batch integrand
+ * fb(x, fx, n), so an expensive model can vectorise across nodes.
+ *
+ * The partition survives between calls: integrate() with a tighter
+ * tolerance continues from where the last call stopped and never
+ * re-evaluates a node whose subinterval is still in use. */
+template<class BatchF>
+class AdaptiveGK15 {
+public:
+    AdaptiveGK15(BatchF batch_f, double a, double b, size_t intervals_per_round = 1)
+        : fb(batch_f), per_round(max<size_t>(intervals_per_round, 1)) {
+        Segment s{a, b, 0.0, 0.0};
+        evaluate(&s, 1);
+        heap.push_back(s);
+        total = s.value;
+        total_error = s.error;
+    }
+
+    /* Refine until error <= max(abs_tol, rel_tol * |I|) or until the
+     * partition holds max_intervals subintervals */
+    QuadResult integrate(double abs_tol, double rel_tol = 0.0, size_t max_intervals = 2000) {
+        vector<Segment> parents, children;
+        bool stuck = false;
+        while (!stuck && total_error > max(abs_tol, rel_tol * fabs(total)) && heap.size() < max_intervals) {
+            parents.clear();
+            children.clear();
+            while (!heap.empty() && parents.size() < per_round) {
+                pop_heap(heap.begin(), heap.end(), by_error);
+                Segment s = heap.back();
+                heap.pop_back();
+
+                double mid = 0.5 * (s.a + s.b);
+                if (mid <= s.a || mid >= s.b) {
+                    /* cannot split any further in double precision: put
+                     * it back, finish the round with the children
+                     * collected so far and stop refining */
+                    heap.push_back(s);
+                    push_heap(heap.begin(), heap.end(), by_error);
+                    stuck = true;
+                    break;
+                }
+                parents.push_back(s);
+                children.push_back(Segment{s.a, mid, 0.0, 0.0});
+                children.push_back(Segment{mid, s.b, 0.0, 0.0});
+            }
+            if (children.empty()) break;
+            evaluate(children.data(), children.size());
+
+            for (const Segment& s : parents) {
+                total -= s.value;
+                total_error -= s.error;
+            }
+            for (const Segment& s : children) {
+                total += s.value;
+                total_error += s.error;
+                heap.push_back(s);
+                push_heap(heap.begin(), heap.end(), by_error);
+            }
+        }
+
+        /* Re-sum the partition to drop the drift of the running totals */
+        total = 0.0;
+        total_error = 0.0;
+        for (const Segment& s : heap) {
+            total += s.value;
+            total_error += s.error;
+        }
+        return result(total_error <= max(abs_tol, rel_tol * fabs(total)));
+    }
+
+    size_t evaluations() const { return n_eval; }
+
+private:
+    struct Segment {
+        double a, b;
+        double value, error;
+    };
+
+    static bool by_error(const Segment& l, const Segment& r) { return l.error < r.error; }
+
+    QuadResult result(bool converged) const {
+        QuadResult res;
+        res.value = total;
+        res.error = total_error;
+        res.evaluations = n_eval;
+        res.intervals = heap.size();
+        res.converged = converged;
+        return res;
+    }
+
+    /* Apply G7K15 to n segments with one batched integrand call */
+    void evaluate(Segment* seg, size_t n) {
+        x.resize(15 * n);
+        fx.resize(15 * n);
+        for (size_t s = 0; s < n; ++s) {
+            double c = 0.5 * (seg[s].a + seg[s].b);
+            double hl = 0.5 * (seg[s].b - seg[s].a);
+            double* xs = &x[15 * s];
+            for (int k = 0; k < 7; ++k) {
+                xs[2 * k] = c - hl * GK15::xgk[k];
+                xs[2 * k + 1] = c + hl * GK15::xgk[k];
+            }
+            xs[14] = c;
+        }
+        fb(x.data(), fx.data(), 15 * n);
+        n_eval += 15 * n;
+
+        for (size_t s = 0; s < n; ++s) {
+            const double* f = &fx[15 * s];
+            double hl = 0.5 * (seg[s].b - seg[s].a);
+
+            double fc = f[14];
+            double res_k = GK15::wgk[7] * fc;
+            double res_g = GK15::wg[3] * fc;
+            double res_abs = fabs(res_k);
+            for (int k = 0; k < 7; ++k) {
+                double pair = f[2 * k] + f[2 * k + 1];
+                res_k += GK15::wgk[k] * pair;
+                res_abs += GK15::wgk[k] * (fabs(f[2 * k]) + fabs(f[2 * k + 1]));
+                if (k % 2 == 1) res_g += GK15::wg[k / 2] * pair;
+            }
+
+            /* QUADPACK error estimate: |K15 - G7| sharpened by the
+             * smoothness indicator res_asc */
+            double mean = 0.5 * res_k;
+            double res_asc = GK15::wgk[7] * fabs(fc - mean);
+            for (int k = 0; k < 7; ++k) {
+                res_asc += GK15::wgk[k] * (fabs(f[2 * k] - mean) + fabs(f[2 * k + 1] - mean));
+            }
+            res_asc *= fabs(hl);
+            res_abs *= fabs(hl);
+
+            double err = fabs((res_k - res_g) * hl);
+            if (res_asc != 0.0 && err != 0.0) err = res_asc * min(1.0, pow(200.0 * err / res_asc, 1.5));
+            if (res_abs > DBL_MIN / (50.0 * DBL_EPSILON)) err = max(err, 50.0 * DBL_EPSILON * res_abs);
+
+            seg[s].value = res_k * hl;
+            seg[s].error = err;
+        }
+    }
+
+    BatchF fb;
+    size_t per_round;
+    vector<Segment> heap;
+    vector<double> x, fx;
+    double total = 0.0;
+    double total_error = 0.0;
+    size_t n_eval = 0;
+};
+
+template<class BatchF>
+AdaptiveGK15<BatchF> make_adaptive_gk15(BatchF fb, double a, double b, size_t intervals_per_round = 1) {
+    return AdaptiveGK15<BatchF>(fb, a, b, intervals_per_round);
+}
+
+/* One-shot adaptive integral of a scalar callable f over [a, b] */
+template<class F>
+QuadResult integrate_gk15(F f, double a, double b, double abs_tol, double rel_tol = 0.0,
+                          size_t max_intervals = 2000) {
+    AdaptiveGK15<BatchedIntegrand<F> > gk(batched(f), a, b);
+    return gk.integrate(abs_tol, rel_tol, max_intervals);
+}
+
+#endif // GAUSS_KRONROD_H_
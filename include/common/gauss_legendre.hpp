@@ -0,0 +1,172 @@
+#ifndef GAUSS_LEGENDRE_H_
+#define GAUSS_LEGENDRE_H_
+
+#include <cstddef>
+#include <iostream>
+#include <vector>
+#include "reduce.hpp"
+
+using namespace std;
+
+/* Gauss-Legendre rules of order N = 2..64 on [-1, 1]:
+ *   int f = sum_i w_i f(x_i),   exact for polynomials of degree 2N-1
+ *
+ * Nodes and weights are computed at compile time: each positive root
+ * of P_N starts from the Tricomi estimate cos(pi (i + 3/4) / (N + 1/2))
+ * and is polished by Newton's method on the three-term recurrence,
+ * w_i = 2 / ((1 - x_i^2) P_N'(x_i)^2). Roots come in +-x pairs, so
+ * only (N+1)/2 of them are solved for. */
+
+namespace gl_detail {
+
+constexpr double PI = 3.141592653589793238462643383279503;
+
+/* cos(x) for x in [0, pi] by its Taylor series (compile-time only) */
+constexpr double cos_taylor(double x) {
+    double term = 1.0, sum = 1.0;
+    for (int k = 1; k < 40; ++k) {
+        term *= -x * x / double((2 * k - 1) * (2 * k));
+        sum += term;
+    }
+    return sum;
+}
+
+constexpr double abs_value(double x) { return x < 0.0 ? -x : x; }
+
+/* P_N(x) and P_N'(x) by the Bonnet recurrence */
+constexpr void legendre(int N, double x, double& p, double& dp) {
+    double p0 = 1.0, p1 = x;
+    for (int k = 2; k <= N; ++k) {
+        double p2 = (double(2 * k - 1) * x * p1 - double(k - 1) * p0) / double(k);
+        p0 = p1;
+        p1 = p2;
+    }
+    p = p1;
+    dp = double(N) * (x * p1 - p0) / (x * x - 1.0);
+}
+
+} // namespace gl_detail
+
+template<int N>
+struct GaussLegendreRule {
+    double x[N] = {};
+    double w[N] = {};
+
+    constexpr GaussLegendreRule() {
+        for (int i = 0; i < (N + 1) / 2; ++i) {
+            double z = gl_detail::cos_taylor(gl_detail::PI * (double(i) + 0.75) / (double(N) + 0.5));
+            double p = 0.0, dp = 1.0;
+            /* quadratic convergence: one more step after |dz| < 1e-10
+             * reaches the rounding level */
+            for (int it = 0; it < 50; ++it) {
+                gl_detail::legendre(N, z, p, dp);
+                double dz = p / dp;
+                z -= dz;
+                if (gl_detail::abs_value(dz) < 1e-10) break;
+            }
+            gl_detail::legendre(N, z, p, dp);
+            z -= p / dp;
+            gl_detail::legendre(N, z, p, dp);
+            double wi = 2.0 / ((1.0 - z * z) * dp * dp);
+            /* ascending order: x[0] = -x_max */
+            x[i] = -z;
+            x[N - 1 - i] = z;
+            w[i] = wi;
+            w[N - 1 - i] = wi;
+        }
+        if (N % 2 == 1) x[N / 2] = 0.0;
+    }
+};
+
+template<int N>
+struct GaussLegendre {
+    static_assert(N >= 2 && N <= 64, "Gauss-Legendre rules are provided for orders 2 to 64");
+    static constexpr GaussLegendreRule<N> rule{};
+};
+
+/* Single N-point rule on [a, b] */
+template<int N, class F>
+double gauss_legendre(F f, double a, double b) {
+    constexpr const GaussLegendreRule<N>& R = GaussLegendre<N>::rule;
+    double c = 0.5 * (a + b), hl = 0.5 * (b - a);
+    double sum = 0.0;
+    for (int i = 0; i < N; ++i) sum += R.w[i] * double(f(c + hl * R.x[i]));
+    return hl * sum;
+}
+
+/* Composite N-point rule on `panels` equal subintervals of [a, b].
+ * The panel sums go through the lane/block reduction, so the result
+ * does not depend on how the panels are scheduled. */
+template<int N, class F>
+double gauss_legendre_composite(F f, double a, double b, size_t panels) {
+    if (panels == 0) return 0.0;
+    double H = (b - a) / double(panels);
+    double sum = reduce_indexed(panels, [&](size_t p) {
+        double pa = (p + 1 == panels) ? b - H : a + double(p) * H;
+        return gauss_legendre<N>(f, pa, pa + H);
+    });
+    return sum;
+}
+
+/* Composite rule with a batch integrand fb(x, fx, n) (same form as
+ * AdaptiveGK15, see gauss_kronrod.hpp): all N * panels nodes are
+ * generated first and evaluated in one call, so a vectorised model
+ * sees them as one contiguous array */
+template<int N, class BatchF>
+double gauss_legendre_batch(BatchF fb, double a, double b, size_t panels = 1) {
+    constexpr const GaussLegendreRule<N>& R = GaussLegendre<N>::rule;
+    if (panels == 0) return 0.0;
+    double H = (b - a) / double(panels);
+    double hl = 0.5 * H;
+
+    vector<double> x(panels * N), fx(panels * N);
+    for (size_t p = 0; p < panels; ++p) {
+        double c = a + (double(p) + 0.5) * H;
+        for (int i = 0; i < N; ++i) x[p * N + size_t(i)] = c + hl * R.x[i];
+    }
+    fb(x.data(), fx.data(), x.size());
+
+    const double* pf = fx.data();
+    double sum = reduce_indexed(panels, [pf, &R](size_t p) {
+        const double* q = pf + p * N;
+        double s = 0.0;
+        for (int i = 0; i < N; ++i) s += R.w[i] * q[i];
+        return s;
+    });
+    return hl * sum;
+}
+
+/* Nodes and weights of the order-`order` rule, found at run time */
+template<int N = 2>
+bool gauss_legendre_table(int order, const double*& x, const double*& w) {
+    if (order == N) {
+        x = GaussLegendre<N>::rule.x;
+        w = GaussLegendre<N>::rule.w;
+        return true;
+    }
+    if constexpr (N < 64) return gauss_legendre_table<N + 1>(order, x, w);
+    else return false;
+}
+
+/* Run-time choice of the order in [2, 64], composite over `panels` */
+template<class F>
+double integrate_gauss_legendre(F f, double a, double b, int order, size_t panels = 1) {
+    const double* x = nullptr;
+    const double* w = nullptr;
+    if (!gauss_legendre_table(order, x, w)) {
+        cerr << "Error: Gauss-Legendre rules are provided for orders 2 to 64, not " << order << endl;
+        return 0.0;
+    }
+    if (panels == 0) return 0.0;
+    double H = (b - a) / double(panels);
+    double hl = 0.5 * H;
+    double sum = reduce_indexed(panels, [&](size_t p) {
+        double c = a + (double(p) + 0.5) * H;
+        double s = 0.0;
+        for (int i = 0; i < order; ++i) s += w[i] * double(f(c + hl * x[i]));
+        return s;
+    });
+    return hl * sum;
+}
+
+#endif // GAUSS_LEGENDRE_H_
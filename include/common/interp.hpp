@@ -9,12 +9,20 @@
 
 using namespace std;
 
-int locate(valarray<float>& xi, float x, bool uniform=true);
-float Lagrange_Nk(int k, valarray<float>& xi, float x);
-float Lagrange_N(valarray<float>& xi, valarray<float>& yi, float x);
+/* Interpolation on a grid xi of scalar type T; instantiated for
+ * float, double and long double in interp.cpp. The evaluation point
+ * has the type of the grid. */
+template<class T>
+int locate(const valarray<T>& xi, T x, bool uniform=true);
+template<class T>
+T Lagrange_Nk(int k, valarray<T>& xi, T x);
+template<class T>
+T Lagrange_N(valarray<T>& xi, valarray<T>& yi, T x);
 
 /* Alternative way of performing interpolation */
-valarray<float> interp_coeffs(const valarray<float>& xi, const valarray<float>& yi);
-float poly_eval(const vector<float>& coeffs, const vector<float>& xi, float x);
+template<class T>
+valarray<T> interp_coeffs(const valarray<T>& xi, const valarray<T>& yi);
+template<class T>
+T poly_eval(const vector<T>& coeffs, const vector<T>& xi, T x);
 
 #endif // INTERP_H_
@@ -0,0 +1,315 @@
+#ifndef KALMAN_H_
+#define KALMAN_H_
+
+#include <array>
+#include <cmath>
+#include <iostream>
+#include <valarray>
+#include <vector>
+#include "thread_pool.hpp"
+
+using namespace std;
+
+/* Kalman filter and Rauch-Tung-Striebel smoother for player tracks.
+ *
+ * Each pitch axis follows the kinematic model of order N:
+ *   N = 2 (constant velocity):     s = [p, v],    white-noise acceleration
+ *   N = 3 (constant acceleration): s = [p, v, a], white-noise jerk
+ * with spectral density q, and only the position is measured, with
+ * standard deviation r. Both axes share F, Q, H and R and are
+ * uncorrelated, so they share one N x N covariance: the gain is
+ * computed once per frame and applied to the x and y states. All
+ * matrices are fixed-size arrays, so predict() and update() do no
+ * dynamic allocation and cost O(1) per frame. */
+
+/* Default tuning for 5 Hz optical player tracking: jerk spectral
+ * density in m^2/s^5 and position noise in m */
+const double KALMAN_Q_PLAYER = 1.0;
+const double KALMAN_R_TRACKING = 0.1;
+
+template<int N, class T>
+using KVec = array<T, N>;
+
+template<int N, class T>
+using KMat = array<array<T, N>, N>;
+
+/* State transition F(dt): Taylor expansion of the kinematic chain */
+template<int N, class T>
+KMat<N, T> kinematic_transition(T dt) {
+    KMat<N, T> F{};
+    for (int i = 0; i < N; ++i) {
+        T term = 1;
+        for (int j = i; j < N; ++j) {
+            F[i][j] = term;
+            term *= dt / T(j - i + 1);
+        }
+    }
+    return F;
+}
+
+/* Discrete process noise of a white-noise N-th derivative:
+ * Q_ij = q dt^(2N-1-i-j) / ((N-1-i)! (N-1-j)! (2N-1-i-j)) */
+template<int N, class T>
+KMat<N, T> kinematic_noise(T dt, T q) {
+    KMat<N, T> Q{};
+    for (int i = 0; i < N; ++i) {
+        for (int j = 0; j < N; ++j) {
+            int a = N - 1 - i, b = N - 1 - j;
+            T fa = 1, fb = 1;
+            for (int k = 2; k <= a; ++k) fa *= T(k);
+            for (int k = 2; k <= b; ++k) fb *= T(k);
+            Q[i][j] = q * pow(dt, T(a + b + 1)) / (fa * fb * T(a + b + 1));
+        }
+    }
+    return Q;
+}
+
+template<int N, class T>
+KMat<N, T> kmat_mul(const KMat<N, T>& A, const KMat<N, T>& B) {
+    KMat<N, T> C{};
+    for (int i = 0; i < N; ++i)
+        for (int k = 0; k < N; ++k)
+            for (int j = 0; j < N; ++j) C[i][j] += A[i][k] * B[k][j];
+    return C;
+}
+
+/* A * B^T */
+template<int N, class T>
+KMat<N, T> kmat_mul_t(const KMat<N, T>& A, const KMat<N, T>& B) {
+    KMat<N, T> C{};
+    for (int i = 0; i < N; ++i)
+        for (int j = 0; j < N; ++j)
+            for (int k = 0; k < N; ++k) C[i][j] += A[i][k] * B[j][k];
+    return C;
+}
+
+template<int N, class T>
+KVec<N, T> kmat_apply(const KMat<N, T>& A, const KVec<N, T>& x) {
+    KVec<N, T> y{};
+    for (int i = 0; i < N; ++i)
+        for (int j = 0; j < N; ++j) y[i] += A[i][j] * x[j];
+    return y;
+}
+
+/* Inverse of a small symmetric positive definite matrix
+ * (Gauss-Jordan elimination, no pivoting needed for SPD) */
+template<int N, class T>
+KMat<N, T> kmat_inverse(KMat<N, T> A) {
+    KMat<N, T> inv{};
+    for (int i = 0; i < N; ++i) inv[i][i] = 1;
+    for (int c = 0; c < N; ++c) {
+        T d = A[c][c];
+        for (int j = 0; j < N; ++j) {
+            A[c][j] /= d;
+            inv[c][j] /= d;
+        }
+        for (int r = 0; r < N; ++r) {
+            if (r == c) continue;
+            T m = A[r][c];
+            for (int j = 0; j < N; ++j) {
+                A[r][j] -= m * A[c][j];
+                inv[r][j] -= m * inv[c][j];
+            }
+        }
+    }
+    return inv;
+}
+
+template<int N, class T = double>
+class KinematicKalman2D {
+public:
+    using Vec = KVec<N, T>;
+    using Mat = KMat<N, T>;
+
+    /* q: spectral density of the driving noise, r: position noise std-dev */
+    KinematicKalman2D(T q_noise, T r_noise) : q(q_noise), r2(r_noise * r_noise) {}
+
+    /* Start the filter on a first position fix. Velocity and
+     * acceleration start at zero with a wide prior. */
+    void init(T t, T x, T y) {
+        sx = Vec{};
+        sy = Vec{};
+        sx[0] = x;
+        sy[0] = y;
+        P = Mat{};
+        P[0][0] = r2;
+        for (int i = 1; i < N; ++i) P[i][i] = T(1e4);
+        time = t;
+        started = true;
+    }
+
+    /* Propagate state and covariance to time t */
+    void predict(T t) {
+        T dt = t - time;
+        if (dt <= 0) return;
+        Mat F = kinematic_transition<N, T>(dt);
+        sx = kmat_apply<N, T>(F, sx);
+        sy = kmat_apply<N, T>(F, sy);
+        P = kmat_mul_t<N, T>(kmat_mul<N, T>(F, P), F);
+        Mat Q = kinematic_noise<N, T>(dt, q);
+        for (int i = 0; i < N; ++i)
+            for (int j = 0; j < N; ++j) P[i][j] += Q[i][j];
+        time = t;
+    }
+
+    /* Per-frame entry point: predict to t and correct with the fix (x, y) */
+    void update(T t, T x, T y) {
+        if (!started) {
+            init(t, x, y);
+            return;
+        }
+        predict(t);
+
+        /* H = [1 0 ...]: innovation variance S = P00 + R, gain K = P[:,0] / S */
+        T S = P[0][0] + r2;
+        Vec K;
+        for (int i = 0; i < N; ++i) K[i] = P[i][0] / S;
+
+        T ex = x - sx[0], ey = y - sy[0];
+        for (int i = 0; i < N; ++i) {
+            sx[i] += K[i] * ex;
+            sy[i] += K[i] * ey;
+        }
+
+        /* P <- (I - K H) P */
+        Mat Pn = P;
+        for (int i = 0; i < N; ++i)
+            for (int j = 0; j < N; ++j) Pn[i][j] -= K[i] * P[0][j];
+        P = Pn;
+    }
+
+    T t() const { return time; }
+    T x() const { return sx[0]; }
+    T y() const { return sy[0]; }
+    T vx() const { return sx[1]; }
+    T vy() const { return sy[1]; }
+    T ax() const {
+        if constexpr (N > 2) return sx[2];
+        else return T(0);
+    }
+    T ay() const {
+        if constexpr (N > 2) return sy[2];
+        else return T(0);
+    }
+
+    const Vec& state_x() const { return sx; }
+    const Vec& state_y() const { return sy; }
+    const Mat& covariance() const { return P; }
+
+private:
+    T q, r2;
+    T time = 0;
+    bool started = false;
+    Vec sx{}, sy{};
+    Mat P{};
+};
+
+/* Smoothed kinematics of one track, one entry per filtered frame */
+struct KinematicTrack {
+    valarray<float> t, x, y, vx, vy, ax, ay;
+};
+
+/* Forward Kalman pass followed by the RTS backward pass over a whole
+ * track (t_i, x_i, y_i). Timestamps may be non-uniform but must
+ * increase: a frame whose timestamp is not after the last one kept
+ * (duplicate or out of order) is dropped with a warning, so the output
+ * has one entry per remaining frame and out.t holds their times. */
+template<int N, class T = double>
+KinematicTrack kalman_smooth(const valarray<float>& t, const valarray<float>& x,
+                             const valarray<float>& y, T q, T r) {
+    using Vec = KVec<N, T>;
+    using Mat = KMat<N, T>;
+
+    vector<size_t> frame;
+    frame.reserve(t.size());
+    for (size_t i = 0; i < t.size(); ++i) {
+        if (frame.empty() ? t[i] == t[i] : t[i] > t[frame.back()]) frame.push_back(i);
+    }
+    if (frame.size() < t.size()) {
+        cerr << "Warning: " << t.size() - frame.size()
+             << " frames without increasing timestamps left out of the Kalman smoother" << endl;
+    }
+
+    size_t n = frame.size();
+    KinematicTrack out;
+    for (valarray<float>* a : {&out.t, &out.x, &out.y, &out.vx, &out.vy, &out.ax, &out.ay}) a->resize(n);
+    if (n == 0) return out;
+
+    /* Forward pass, keeping filtered and predicted moments and the
+     * interval each prediction actually covered, so that the backward
+     * pass uses the same F as the P_k+1|k it inverts */
+    vector<Vec> fx(n), fy(n);
+    vector<Mat> fP(n), pP(n);
+    vector<T> step(n, T(0));
+    KinematicKalman2D<N, T> kf(q, r);
+    for (size_t k = 0; k < n; ++k) {
+        size_t i = frame[k];
+        if (k > 0) {
+            T t_prev = kf.t();
+            kf.predict(T(t[i]));
+            step[k] = kf.t() - t_prev;
+            pP[k] = kf.covariance();
+        }
+        kf.update(T(t[i]), T(x[i]), T(y[i]));
+        fx[k] = kf.state_x();
+        fy[k] = kf.state_y();
+        fP[k] = kf.covariance();
+    }
+
+    /* Backward pass: s_k|n = s_k|k + C_k (s_k+1|n - F s_k|k),
+     * C_k = P_k|k F^T P_k+1|k^-1 */
+    Vec sx = fx[n - 1], sy = fy[n - 1];
+    auto store = [&](size_t k) {
+        out.t[k] = t[frame[k]];
+        out.x[k] = float(sx[0]);
+        out.y[k] = float(sy[0]);
+        out.vx[k] = float(sx[1]);
+        out.vy[k] = float(sy[1]);
+        if constexpr (N > 2) {
+            out.ax[k] = float(sx[2]);
+            out.ay[k] = float(sy[2]);
+        } else {
+            out.ax[k] = out.ay[k] = 0.0f;
+        }
+    };
+    store(n - 1);
+    for (size_t k = n - 1; k-- > 0;) {
+        Mat F = kinematic_transition<N, T>(step[k + 1]);
+        Mat C = kmat_mul<N, T>(kmat_mul_t<N, T>(fP[k], F), kmat_inverse<N, T>(pP[k + 1]));
+        Vec px = kmat_apply<N, T>(F, fx[k]);
+        Vec py = kmat_apply<N, T>(F, fy[k]);
+        for (int i = 0; i < N; ++i) {
+            px[i] = sx[i] - px[i];
+            py[i] = sy[i] - py[i];
+        }
+        Vec cx = kmat_apply<N, T>(C, px);
+        Vec cy = kmat_apply<N, T>(C, py);
+        for (int i = 0; i < N; ++i) {
+            sx[i] = fx[k][i] + cx[i];
+            sy[i] = fy[k][i] + cy[i];
+        }
+        store(k);
+    }
+
+    return out;
+}
+
+/* Raw input of the batch smoother */
+struct PositionTrack {
+    valarray<float> t, x, y;
+};
+
+/* Smooth many tracks in parallel, one task per track */
+template<int N, class T = double>
+vector<KinematicTrack> kalman_smooth_tracks(const vector<PositionTrack>& tracks, T q, T r,
+                                            ThreadPool& pool) {
+    vector<KinematicTrack> out(tracks.size());
+    parallel_for(pool, tracks.size(), 1, [&](size_t first, size_t last) {
+        for (size_t i = first; i < last; ++i) {
+            out[i] = kalman_smooth<N, T>(tracks[i].t, tracks[i].x, tracks[i].y, q, r);
+        }
+    });
+    return out;
+}
+
+#endif // KALMAN_H_
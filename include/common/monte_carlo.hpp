@@ -0,0 +1,72 @@
+#ifndef MONTE_CARLO_H_
+#define MONTE_CARLO_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "ensemble.hpp"
+#include "thread_pool.hpp"
+
+using namespace std;
+
+/* Monte Carlo estimate of the shot outcome probabilities.
+ *
+ * Sample i perturbs the nominal launch with independent normal
+ * deviates drawn from Philox4x32 at counter i (philox.hpp), so every
+ * sample is reproducible on its own. Samples are simulated in tasks of
+ * samples_per_task shots on the work-stealing pool (each task is a
+ * run of ensemble batches, see ensemble.hpp), one round of
+ * tasks_per_round tasks at a time. After each round the counts are
+ * merged in task order and the run stops once the confidence interval
+ * of every outcome probability is narrower than the target. Rounds and
+ * tasks depend only on the options, so the result is the same for any
+ * number of threads. */
+
+/* Standard deviations of the launch perturbations */
+struct ShotSpread {
+    float speed = 0.5f;         // m/s
+    float elevation = 0.01f;    // rad
+    float azimuth = 0.01f;      // rad
+    float spin_z = 2.0f;        // rad/s
+    float drag_scale = 0.05f;   // relative
+};
+
+struct MonteCarloOptions {
+    uint64_t seed = 1;
+    float dt = 0.01f;
+    BallPhysics physics;
+    size_t samples_per_task = 1024;
+    size_t tasks_per_round = 16;
+    size_t min_samples = 4096;
+    size_t max_samples = size_t(1) << 22;
+    double ci_halfwidth = 0.005;    // target half-width of each probability (Wilson interval)
+    double z = 1.96;                // normal quantile of the confidence level
+};
+
+/* Histogram of the crossing points (y, z of the ball centre) on the
+ * goal plane x = PITCH_L/2, over [y_min, y_max] x [z_min, z_max] */
+struct GoalPlaneHistogram {
+    float y_min = -6.0f, y_max = 6.0f;
+    float z_min = 0.0f, z_max = 4.0f;
+    size_t ny = 48, nz = 16;
+    vector<size_t> counts;      // counts[iz * ny + iy]
+    size_t outside = 0;         // goal-plane crossings outside the range
+};
+
+struct MonteCarloResult {
+    size_t samples = 0;
+    size_t count[4] = {0, 0, 0, 0};     // indexed by ShotOutcome
+    double probability[4] = {0.0, 0.0, 0.0, 0.0};
+    double ci_halfwidth[4] = {0.0, 0.0, 0.0, 0.0};
+    bool converged = false;
+
+    /* moments of the goal-plane crossing point (GOOD and OVER shots) */
+    double mean_y = 0.0, mean_z = 0.0;
+    double sd_y = 0.0, sd_z = 0.0;
+    GoalPlaneHistogram landing;
+};
+
+MonteCarloResult estimate_shot_outcomes(const ShotLaunch& nominal, const ShotSpread& spread,
+                                        const MonteCarloOptions& options, ThreadPool& pool);
+
+#endif // MONTE_CARLO_H_
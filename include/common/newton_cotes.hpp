@@ -0,0 +1,264 @@
+#ifndef NEWTON_COTES_H_
+#define NEWTON_COTES_H_
+
+#include <algorithm>
+#include <cstddef>
+#include <iostream>
+#include "array_view.hpp"
+#include "reduce.hpp"
+
+using namespace std;
+
+/* Closed Newton-Cotes rules on NP equally spaced points (NP-1
+ * intervals of width h):
+ *   int = h * scale * sum_j w[j] f_j,   error O(h^(order+1)) per panel
+ *
+ *   NP = 2  trapezoid          (1 1) / 2
+ *   NP = 3  Simpson 1/3        (1 4 1) / 3
+ *   NP = 4  Simpson 3/8        (1 3 3 1) * 3/8
+ *   NP = 5  Boole              (7 32 12 32 7) * 2/45
+ *   NP = 6  6-point            (19 75 50 50 75 19) * 5/288 */
+template<int NP> struct NewtonCotes;
+
+template<> struct NewtonCotes<2> {
+    static constexpr double w[2] = {1.0, 1.0};
+    static constexpr double scale = 1.0 / 2.0;
+    static constexpr int order = 2;
+};
+
+template<> struct NewtonCotes<3> {
+    static constexpr double w[3] = {1.0, 4.0, 1.0};
+    static constexpr double scale = 1.0 / 3.0;
+    static constexpr int order = 4;
+};
+
+template<> struct NewtonCotes<4> {
+    static constexpr double w[4] = {1.0, 3.0, 3.0, 1.0};
+    static constexpr double scale = 3.0 / 8.0;
+    static constexpr int order = 4;
+};
+
+template<> struct NewtonCotes<5> {
+    static constexpr double w[5] = {7.0, 32.0, 12.0, 32.0, 7.0};
+    static constexpr double scale = 2.0 / 45.0;
+    static constexpr int order = 6;
+};
+
+template<> struct NewtonCotes<6> {
+    static constexpr double w[6] = {19.0, 75.0, 50.0, 50.0, 75.0, 19.0};
+    static constexpr double scale = 5.0 / 288.0;
+    static constexpr int order = 6;
+};
+
+/* Sample map of the plain integral: the samples themselves */
+struct Identity {
+    template<class T>
+    double operator()(T x) const { return double(x); }
+};
+
+/* Composite NP-point rule over `panels` whole panels starting at f.
+ * Neighbouring panels share an end point, which therefore carries
+ * w[0] + w[NP-1] = 2 w[0]. Panels are reduced with the lane/block
+ * kernel; the inner NP-term loop has a compile-time trip count and
+ * is fully unrolled. The integrand is map(f[i]), evaluated as the
+ * samples stream past (see energy_kernel.hpp). */
+template<int NP, class T, class Map = Identity>
+double nc_panels(const T* f, size_t panels, double h, const Map& map = Map()) {
+    using R = NewtonCotes<NP>;
+    if (panels == 0) return 0.0;
+
+    double sum = reduce_indexed(panels, [f, &map](size_t p) {
+        const T* q = f + p * (NP - 1);
+        double s = 2.0 * R::w[0] * map(q[0]);
+        for (int j = 1; j < NP - 1; ++j) s += R::w[j] * map(q[j]);
+        return s;
+    });
+    sum -= R::w[0] * map(f[0]);
+    sum += R::w[0] * map(f[panels * (NP - 1)]);
+    return h * R::scale * sum;
+}
+
+/* Single rule on the first np points of f, np chosen at run time */
+template<class T, class Map = Identity>
+double nc_single(const T* f, size_t np, double h, const Map& map = Map()) {
+    switch (np) {
+    case 2: return nc_panels<2>(f, 1, h, map);
+    case 3: return nc_panels<3>(f, 1, h, map);
+    case 4: return nc_panels<4>(f, 1, h, map);
+    case 5: return nc_panels<5>(f, 1, h, map);
+    case 6: return nc_panels<6>(f, 1, h, map);
+    default: return 0.0;
+    }
+}
+
+/* Smallest single rule (in intervals) that keeps the order of the
+ * NP-point rule: Simpson's 1/3 and 3/8 rules are both of order 4,
+ * Boole and the 6-point rule both of order 6 */
+inline size_t nc_min_tail_intervals(int NP) { return NP == 2 ? 1 : (NP <= 4 ? 2 : 4); }
+
+/* Split of `intervals` into `body` whole NP-point panels followed by
+ * `parts` single rules of len[k] <= 5 intervals each */
+struct NCSplit {
+    size_t body = 0;
+    size_t parts = 0;
+    size_t len[4] = {0, 0, 0, 0};
+};
+
+inline NCSplit nc_split(size_t intervals, int NP) {
+    NCSplit s;
+    const size_t m = size_t(NP - 1), q = nc_min_tail_intervals(NP);
+    const size_t r = intervals % m;
+    s.body = intervals / m;
+    if (r == 0) return s;
+
+    /* Fold up to three body panels into the tail until it splits into
+     * 1-4 rules of q..5 intervals each */
+    for (size_t fold = 1; fold <= 3 && fold <= s.body; ++fold) {
+        size_t L = r + fold * m;
+        size_t k = (L + 4) / 5;
+        if (k <= 4 && k * q <= L) {
+            s.body -= fold;
+            s.parts = k;
+            for (size_t i = 0; i < k; ++i) s.len[i] = L / k + (i < L % k ? 1 : 0);
+            return s;
+        }
+    }
+
+    /* Too few samples for that: the last panel and the remainder as one
+     * rule, or two of about half the length each (lower order) */
+    size_t fold = min<size_t>(s.body, 1);
+    size_t L = r + fold * m;
+    s.body -= fold;
+    if (L <= 5) {
+        s.parts = 1;
+        s.len[0] = L;
+    } else {
+        s.parts = 2;
+        s.len[0] = (L + 1) / 2;
+        s.len[1] = L - s.len[0];
+    }
+    return s;
+}
+
+/* Composite NP-point Newton-Cotes integral of the samples f (spacing h)
+ * for ANY number of samples. Whole NP-point panels cover the series
+ * except a remainder of r < NP-1 intervals; the remainder and one to
+ * three of the last panels are then integrated as up to four single
+ * rules of at most 6 points, each of the same order as the body rule,
+ * e.g. Simpson 1/3 on an odd number of intervals ends with one 3/8
+ * panel and Boole on 4k+2 intervals with two 6-point rules. Only
+ * series too short to fold panels fall back to lower-order tails. */
+template<int NP, class T, class Map = Identity>
+double integrate_nc(array_view<const T> f, double h, const Map& map = Map()) {
+    static_assert(NP >= 2 && NP <= 6, "Newton-Cotes rules are provided for 2 to 6 points");
+    size_t n = f.size();
+    if (n < 2) return 0.0;
+    if (n <= size_t(NP)) return nc_single(f.data(), n, h, map);
+
+    const size_t m = NP - 1;
+    NCSplit split = nc_split(n - 1, NP);
+    double sum = nc_panels<NP>(f.data(), split.body, h, map);
+
+    const T* tail = f.data() + split.body * m;
+    for (size_t k = 0; k < split.parts; ++k) {
+        sum += nc_single(tail, split.len[k] + 1, h, map);
+        tail += split.len[k];
+    }
+    return sum;
+}
+
+/* Weight of sample i in the composite rule integrate_nc<NP>() applies
+ * to n samples (without the factor h), for integrands that are
+ * evaluated on the fly instead of being tabulated first */
+class CompositeWeights {
+public:
+    CompositeWeights(size_t n_points, int NCpoints) : n(n_points), m(size_t(NCpoints - 1)) {
+        switch (NCpoints) {
+        case 2: set_rule<2>(); break;
+        case 3: set_rule<3>(); break;
+        case 4: set_rule<4>(); break;
+        case 5: set_rule<5>(); break;
+        case 6: set_rule<6>(); break;
+        default:
+            cerr << "Error: Newton-Cotes rules are provided for 2 to 6 points, not " << NCpoints << endl;
+            n = 0;
+            return;
+        }
+
+        /* Same panel/tail split as integrate_nc() */
+        if (n < 2) {
+            n = 0;
+        } else if (n <= m + 1) {
+            body_end = 0;
+            add_tail_rule(0, n);
+        } else {
+            NCSplit split = nc_split(n - 1, NCpoints);
+            body_end = split.body * m;
+            size_t np0 = 0;
+            for (size_t k = 0; k < split.parts; ++k) {
+                add_tail_rule(np0, split.len[k] + 1);
+                np0 += split.len[k];
+            }
+        }
+    }
+
+    size_t size() const { return n; }
+
+    double operator()(size_t i) const {
+        double w = 0.0;
+        if (i <= body_end && body_end > 0) {
+            size_t j = i % m;
+            w = (j == 0) ? ((i == 0 || i == body_end) ? edge : 2.0 * edge) : panel[j];
+        }
+        if (i >= body_end && i - body_end < TAIL) w += tail[i - body_end];
+        return w;
+    }
+
+private:
+    template<int NP>
+    void set_rule() {
+        for (int j = 0; j < NP; ++j) panel[j] = NewtonCotes<NP>::scale * NewtonCotes<NP>::w[j];
+        edge = panel[0];
+    }
+
+    /* Single rule of np points starting np0 samples into the tail */
+    void add_tail_rule(size_t np0, size_t np) {
+        for (size_t j = 0; j < np; ++j) tail[np0 + j] += single_weight(np, j);
+    }
+
+    static double single_weight(size_t np, size_t j) {
+        switch (np) {
+        case 2: return NewtonCotes<2>::scale * NewtonCotes<2>::w[j];
+        case 3: return NewtonCotes<3>::scale * NewtonCotes<3>::w[j];
+        case 4: return NewtonCotes<4>::scale * NewtonCotes<4>::w[j];
+        case 5: return NewtonCotes<5>::scale * NewtonCotes<5>::w[j];
+        case 6: return NewtonCotes<6>::scale * NewtonCotes<6>::w[j];
+        default: return 0.0;
+        }
+    }
+
+    size_t n;
+    size_t m;
+    size_t body_end = 0;      // last sample covered by whole panels
+    double edge = 0.0;        // weight of a body end point
+    double panel[6] = {0.0};  // scaled panel weights
+    static const size_t TAIL = 21;
+    double tail[TAIL] = {0.0};  // weights of the (at most 20 interval) tail
+};
+
+/* Run-time choice of the rule, NCpoints in [2, 6] */
+template<class T, class Map = Identity>
+double integrate_nc(array_view<const T> f, double h, int NCpoints, const Map& map = Map()) {
+    switch (NCpoints) {
+    case 2: return integrate_nc<2, T>(f, h, map);
+    case 3: return integrate_nc<3, T>(f, h, map);
+    case 4: return integrate_nc<4, T>(f, h, map);
+    case 5: return integrate_nc<5, T>(f, h, map);
+    case 6: return integrate_nc<6, T>(f, h, map);
+    default:
+        cerr << "Error: Newton-Cotes rules are provided for 2 to 6 points, not " << NCpoints << endl;
+        return 0.0;
+    }
+}
+
+#endif // NEWTON_COTES_H_
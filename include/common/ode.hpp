@@ -0,0 +1,182 @@
+#ifndef ODE_H_
+#define ODE_H_
+
+#include <cstddef>
+#include <type_traits>
+#include "rk4.hpp"
+#include "butcher.hpp"
+#include "dopri45.hpp"
+#include "ode_events.hpp"
+
+using namespace std;
+
+/* Generic ODE driver for any system y' = f(t, y).
+ *
+ * State is std::array<T, n> or any fixed-size vector type with
+ * value_type, size(), operator[] and a default constructor (ball,
+ * player or any other model); the right-hand side is any callable
+ * rhs(t, y, dydt) - a lambda, a ForceModel, a functor with parameters.
+ * Its type is a template parameter of the solver, so the calls inline
+ * into the stage loops; there is no function pointer or std::function
+ * on the per-step path.
+ *
+ * Solvers share the interface of DormandPrince45:
+ *   step(t_end)            one step, false once t_end is reached
+ *   t(), state()           end of the last step
+ *   t_prev(), state_prev() start of the last step
+ *   dense(s, y)            state anywhere in the last step
+ *   evaluations()          rhs() calls so far
+ * FixedStepSolver<Method> runs any method of butcher.hpp or
+ * symplectic.hpp (or RK4Step, rk4_step() itself) with a constant step;
+ * its dense output is the cubic Hermite interpolant of the step end
+ * points, whose two slopes are only computed when it is used.
+ *
+ * integrate(solver, t_end, observe, stop) runs a solver to t_end.
+ * After every step stop() is asked first, then observe() is called;
+ * the observer thus sees the step on which stop() fired (and can find
+ * the event inside it). Both take either (t, y) or the solver itself,
+ * for access to the step interval and dense output. */
+
+/* rk4_step() in the step() interface of butcher.hpp */
+struct RK4Step {
+    static constexpr int order = 4;
+    static constexpr const char* name = "rk4";
+
+    template<class State, class RHS>
+    static int step(RHS&& rhs, typename State::value_type t, State& y, typename State::value_type h) {
+        rk4_step(rhs, t, y, h);
+        return 4;
+    }
+};
+
+template<class Method, class State, class RHS>
+class FixedStepSolver {
+public:
+    using T = typename State::value_type;
+
+    FixedStepSolver(RHS f, T t0, const State& y0, T h) : rhs(f), t_start(t0), dt(h), tc(t0), tp(t0), yc(y0), yp(y0) {}
+
+    /* One step of size h; the last one is shortened to end at t_end.
+     * The time is t0 + k h from the step count, so it does not drift
+     * for small h. */
+    bool step(T t_end) {
+        if (!(tc < t_end) || !(dt > T(0))) return false;
+        T tn = t_start + T(k + 1) * dt, hs = dt;
+        if (tn > t_end) {
+            tn = t_end;
+            hs = t_end - tc;
+        }
+        tp = tc;
+        yp = yc;
+        fp = fc;
+        fp_valid = fc_valid;
+        fc_valid = false;
+        n_eval += size_t(Method::step(rhs, tc, yc, hs));
+        tc = tn;
+        k++;
+        return true;
+    }
+
+    void dense(T s, State& y) const {
+        if (!fp_valid) slope(tp, yp, fp, fp_valid);
+        if (!fc_valid) slope(tc, yc, fc, fc_valid);
+        hermite_interp(tp, yp, fp, tc, yc, fc, s, y);
+    }
+
+    T t() const { return tc; }
+    T t_prev() const { return tp; }
+    const State& state() const { return yc; }
+    const State& state_prev() const { return yp; }
+    T step_size() const { return dt; }
+    size_t evaluations() const { return n_eval; }
+    size_t accepted() const { return k; }
+
+private:
+    void slope(T t, const State& y, State& f, bool& valid) const {
+        rhs(t, y, f);
+        n_eval++;
+        valid = true;
+    }
+
+    mutable RHS rhs;                    // also called from dense()
+    T t_start, dt;
+    T tc, tp;
+    State yc, yp;
+    mutable State fc, fp;               // dy/dt at the step ends, on demand
+    mutable bool fc_valid = false, fp_valid = false;
+    mutable size_t n_eval = 0;
+    size_t k = 0;
+};
+
+template<class Method, class State, class RHS>
+FixedStepSolver<Method, State, RHS> make_fixed_step_solver(RHS f, typename State::value_type t0, const State& y0,
+                                                           typename State::value_type h) {
+    return FixedStepSolver<Method, State, RHS>(f, t0, y0, h);
+}
+
+/* Default observer and stop condition */
+struct NoObserver {
+    template<class T, class State>
+    void operator()(T, const State&) const {}
+};
+
+struct NeverStop {
+    template<class T, class State>
+    bool operator()(T, const State&) const { return false; }
+};
+
+template<class T>
+struct OdeResult {
+    T t;              // time reached
+    size_t steps;     // accepted steps
+    size_t evaluations;
+    bool stopped;     // ended by the stop condition, not at t_end
+};
+
+/* f(t, y) if f takes that, else f(solver) */
+template<class Solver, class F>
+auto ode_callback(F& f, const Solver& solver) {
+    using T = typename Solver::T;
+    using State = typename remove_cv<typename remove_reference<decltype(solver.state())>::type>::type;
+    if constexpr (is_invocable<F&, T, const State&>::value) return f(solver.t(), solver.state());
+    else return f(solver);
+}
+
+template<class Solver, class Observer = NoObserver, class Stop = NeverStop>
+OdeResult<typename Solver::T> integrate(Solver& solver, typename Solver::T t_end, Observer&& observe = Observer(),
+                                        Stop&& stop = Stop()) {
+    size_t steps = 0;
+    while (solver.step(t_end)) {
+        ++steps;
+        bool done = ode_callback(stop, solver);
+        ode_callback(observe, solver);
+        if (done) return OdeResult<typename Solver::T>{solver.t(), steps, solver.evaluations(), true};
+    }
+    return OdeResult<typename Solver::T>{solver.t(), steps, solver.evaluations(), false};
+}
+
+/* Fixed steps of h with Method from (t0, y) to t_end; y is advanced in
+ * place to the end of the last step */
+template<class Method = RK4Step, class State, class RHS, class Observer = NoObserver, class Stop = NeverStop>
+OdeResult<typename State::value_type> integrate_fixed(RHS rhs, typename State::value_type t0, State& y,
+                                                      typename State::value_type h, typename State::value_type t_end,
+                                                      Observer&& observe = Observer(), Stop&& stop = Stop()) {
+    FixedStepSolver<Method, State, RHS> solver(rhs, t0, y, h);
+    OdeResult<typename State::value_type> r = integrate(solver, t_end, observe, stop);
+    y = solver.state();
+    return r;
+}
+
+/* Adaptive Dormand-Prince RK45 from (t0, y) to t_end */
+template<class State, class RHS, class Observer = NoObserver, class Stop = NeverStop>
+OdeResult<typename State::value_type> integrate_adaptive(RHS rhs, typename State::value_type t0, State& y,
+                                                         typename State::value_type t_end,
+                                                         const DoPriOptions& options = DoPriOptions(),
+                                                         Observer&& observe = Observer(), Stop&& stop = Stop()) {
+    DormandPrince45<State, RHS> solver(rhs, t0, y, options);
+    OdeResult<typename State::value_type> r = integrate(solver, t_end, observe, stop);
+    y = solver.state();
+    return r;
+}
+
+#endif // ODE_H_
@@ -0,0 +1,170 @@
+#ifndef ODE_EVENTS_H_
+#define ODE_EVENTS_H_
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <vector>
+
+using namespace std;
+
+/* Event detection for the ODE steppers (rk4.hpp, dopri45.hpp).
+ *
+ * An event is a zero of a user function g(t, y). After every step the
+ * locator compares the signs of g at both ends; on a crossing in the
+ * requested direction the exact time is found by the Illinois variant
+ * of regula falsi on s -> g(s, y(s)), where y(s) comes from the step's
+ * interpolant (the dense output of RK45, or a cubic Hermite between
+ * the end points of a fixed RK4 step). The crossing is therefore
+ * located to rounding level with any step size. */
+
+/* Rising: g goes from negative to non-negative, Falling: the reverse */
+enum class EventDirection { Any, Rising, Falling };
+
+template<class State>
+struct EventHit {
+    int id;               // index returned by EventLocator::add()
+    typename State::value_type t;
+    State y;
+    bool terminal;
+};
+
+/* Zero of g in the bracket [a, b] with g(a) ga and g(b) gb of opposite
+ * sign, by the Illinois method: regula falsi that halves the retained
+ * end value when the same end is kept twice, which restores
+ * superlinear convergence. Stops when the bracket is narrower than tol. */
+template<class T, class G>
+T illinois_root(G g, T a, T ga, T b, T gb, T tol, int max_iter = 60) {
+    int side = 0;
+    T c = b;
+    for (int it = 0; it < max_iter; ++it) {
+        c = (a * gb - b * ga) / (gb - ga);
+        if (!(c > min(a, b) && c < max(a, b))) c = T(0.5) * (a + b);
+        T gc = g(c);
+        if (gc == T(0)) return c;
+        if ((gc > T(0)) == (gb > T(0))) {
+            b = c;
+            gb = gc;
+            if (side == -1) ga /= T(2);
+            side = -1;
+        } else {
+            a = c;
+            ga = gc;
+            if (side == 1) gb /= T(2);
+            side = 1;
+        }
+        if (fabs(b - a) <= tol) break;
+    }
+    return c;
+}
+
+/* Cubic Hermite interpolation of a step from (t0, y0, f0) to
+ * (t1, y1, f1), f = dy/dt, at time s */
+template<class State>
+void hermite_interp(typename State::value_type t0, const State& y0, const State& f0,
+                    typename State::value_type t1, const State& y1, const State& f1,
+                    typename State::value_type s, State& y) {
+    using T = typename State::value_type;
+    T h = t1 - t0;
+    T th = (h != T(0)) ? (s - t0) / h : T(1);
+    T th2 = th * th, th3 = th2 * th;
+    T h00 = T(2) * th3 - T(3) * th2 + T(1);
+    T h10 = th3 - T(2) * th2 + th;
+    T h01 = T(3) * th2 - T(2) * th3;
+    T h11 = th3 - th2;
+    for (size_t i = 0; i < y.size(); ++i) {
+        y[i] = h00 * y0[i] + h10 * h * f0[i] + h01 * y1[i] + h11 * h * f1[i];
+    }
+}
+
+template<class State>
+class EventLocator {
+public:
+    using T = typename State::value_type;
+    using EventFunction = function<T(T, const State&)>;
+
+    /* Register g(t, y); a terminal event ends the integration.
+     * Returns the event id reported in EventHit. */
+    int add(EventFunction g, EventDirection direction = EventDirection::Any, bool terminal = true) {
+        events.push_back(Event{g, direction, terminal, T(0)});
+        return int(events.size()) - 1;
+    }
+
+    /* Absolute time tolerance of the root finder; the default is
+     * rounding level relative to t */
+    void set_time_tolerance(T tol) { time_tol = tol; }
+
+    /* Evaluate the events at the initial point. A g that starts at
+     * exactly zero only fires once it has left zero and crosses back. */
+    void start(T t0, const State& y0) {
+        for (Event& e : events) e.g_prev = e.g(t0, y0);
+        t_prev = t0;
+        found.clear();
+        stopped = false;
+    }
+
+    /* Test the step that ended at (t1, y1). interp(s, y) must fill the
+     * state at any s in the step. Crossings are recorded in time
+     * order up to the first terminal one; returns true if that one
+     * exists, i.e. the integration should stop at terminal_event(). */
+    template<class Interp>
+    bool check(T t1, const State& y1, Interp interp) {
+        if (stopped) return true;
+        size_t first_new = found.size();
+        for (size_t k = 0; k < events.size(); ++k) {
+            Event& e = events[k];
+            T g0 = e.g_prev;
+            T g1 = e.g(t1, y1);
+            e.g_prev = g1;
+
+            bool rising = g0 < T(0) && g1 >= T(0);
+            bool falling = g0 > T(0) && g1 <= T(0);
+            if (!((rising && e.direction != EventDirection::Falling) ||
+                  (falling && e.direction != EventDirection::Rising))) continue;
+
+            State ys;
+            auto g_at = [&](T s) {
+                interp(s, ys);
+                return e.g(s, ys);
+            };
+            T tol = max(time_tol, T(4) * numeric_limits<T>::epsilon() * max(fabs(t_prev), fabs(t1)));
+            T ts = (g1 == T(0)) ? t1 : illinois_root(g_at, t_prev, g0, t1, g1, tol);
+            State yr = y1;
+            if (ts != t1) interp(ts, yr);
+            found.push_back(EventHit<State>{int(k), ts, yr, e.terminal});
+        }
+        t_prev = t1;
+
+        sort(found.begin() + long(first_new), found.end(),
+             [](const EventHit<State>& a, const EventHit<State>& b) { return a.t < b.t; });
+        for (size_t i = first_new; i < found.size(); ++i) {
+            if (found[i].terminal) {
+                found.resize(i + 1);
+                stopped = true;
+                break;
+            }
+        }
+        return stopped;
+    }
+
+    bool terminated() const { return stopped; }
+    const EventHit<State>& terminal_event() const { return found.back(); }
+    const vector<EventHit<State> >& hits() const { return found; }
+
+private:
+    struct Event {
+        EventFunction g;
+        EventDirection direction;
+        bool terminal;
+        T g_prev;
+    };
+
+    vector<Event> events;
+    vector<EventHit<State> > found;
+    T t_prev = T(0);
+    T time_tol = T(0);
+    bool stopped = false;
+};
+
+#endif // ODE_EVENTS_H_
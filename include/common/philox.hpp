@@ -0,0 +1,61 @@
+#ifndef PHILOX_H_
+#define PHILOX_H_
+
+#include <array>
+#include <cmath>
+#include <cstdint>
+
+using namespace std;
+
+/* Philox4x32-10 counter-based random number generator (Salmon et al.,
+ * "Parallel random numbers: as easy as 1, 2, 3", SC'11).
+ *
+ * The output is a pure function of a 128-bit counter and a 64-bit key,
+ * so sample i of stream `seed` can be generated on any thread, in any
+ * order, without shared state: results do not depend on scheduling. */
+class Philox4x32 {
+public:
+    using Counter = array<uint32_t, 4>;
+
+    explicit Philox4x32(uint64_t seed) : k0(uint32_t(seed)), k1(uint32_t(seed >> 32)) {}
+
+    Counter operator()(Counter c) const {
+        uint32_t key0 = k0, key1 = k1;
+        for (int r = 0; r < 10; ++r) {
+            uint64_t p0 = uint64_t(M0) * c[0];
+            uint64_t p1 = uint64_t(M1) * c[2];
+            c = Counter{uint32_t(p1 >> 32) ^ c[1] ^ key0, uint32_t(p1), uint32_t(p0 >> 32) ^ c[3] ^ key1, uint32_t(p0)};
+            key0 += W0;
+            key1 += W1;
+        }
+        return c;
+    }
+
+    /* Four uniforms in the open interval (0, 1) for counter c */
+    array<double, 4> uniform(const Counter& c) const {
+        Counter x = (*this)(c);
+        array<double, 4> u;
+        for (int i = 0; i < 4; ++i) u[i] = (double(x[i]) + 0.5) * (1.0 / 4294967296.0);
+        return u;
+    }
+
+    /* Four standard normal deviates for counter c (Box-Muller) */
+    array<double, 4> normal(const Counter& c) const {
+        array<double, 4> u = uniform(c);
+        array<double, 4> z;
+        for (int i = 0; i < 4; i += 2) {
+            double r = sqrt(-2.0 * log(u[i]));
+            double phi = 2.0 * M_PI * u[i + 1];
+            z[i] = r * cos(phi);
+            z[i + 1] = r * sin(phi);
+        }
+        return z;
+    }
+
+private:
+    static const uint32_t M0 = 0xD2511F53u, M1 = 0xCD9E8D57u;
+    static const uint32_t W0 = 0x9E3779B9u, W1 = 0xBB67AE85u;
+    uint32_t k0, k1;
+};
+
+#endif // PHILOX_H_
@@ -0,0 +1,56 @@
+#ifndef PREFIX_INTEGRAL_H_
+#define PREFIX_INTEGRAL_H_
+
+#include <cstddef>
+#include <vector>
+#include "array_view.hpp"
+
+using namespace std;
+
+/* Local rule used for each sample interval */
+enum class PrefixRule {
+    Trapezoid,  // linear interpolant, O(h^2)
+    Cubic       // 4-point Lagrange cubic through the neighbouring samples, O(h^4)
+};
+
+/* Cumulative integral of equally spaced samples f_i = f(t0 + i*h).
+ *
+ * One O(n) pass stores C_i = int_{t0}^{t_i} f dt (in double). The
+ * integral over any window [ta, tb] is then F(tb) - F(ta), where F(t)
+ * adds to C_i the integral of the local interpolant from t_i to t,
+ * so a query costs O(1) whatever the window length. Samples can be
+ * appended one at a time for live data; only the last few intervals,
+ * whose cubic stencil changes, are recomputed. */
+class PrefixIntegral {
+public:
+    PrefixIntegral(float t_start, float step, PrefixRule local_rule = PrefixRule::Trapezoid);
+    PrefixIntegral(array_view<const float> f, float t_start, float step,
+                   PrefixRule local_rule = PrefixRule::Trapezoid);
+
+    /* Streaming mode: add the sample at t0 + size()*h */
+    void append(float fi);
+
+    /* F(t) = int_{t0}^{t} f dt, t clamped to the sampled span */
+    double cumulative(double t) const;
+
+    /* int_{ta}^{tb} f dt */
+    double integral(double ta, double tb) const { return cumulative(tb) - cumulative(ta); }
+
+    /* Batch of windows [ta[k], tb[k]] */
+    vector<double> integral(array_view<const float> ta, array_view<const float> tb) const;
+
+    size_t size() const { return f.size(); }
+    double t_start() const { return t0; }
+    double t_end() const { return t0 + h * double(f.size() ? f.size() - 1 : 0); }
+
+private:
+    double interval_integral(size_t j, double s) const;
+    void update_from(size_t j);
+
+    double t0, h;
+    PrefixRule rule;
+    vector<float> f;
+    vector<double> C;
+};
+
+#endif // PREFIX_INTEGRAL_H_
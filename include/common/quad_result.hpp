@@ -0,0 +1,16 @@
+#ifndef QUAD_RESULT_H_
+#define QUAD_RESULT_H_
+
+#include <cstddef>
+
+/* Value and error estimate returned by the adaptive and
+ * extrapolating integrators */
+struct QuadResult {
+    double value = 0.0;
+    double error = 0.0;
+    size_t evaluations = 0;   // integrand evaluations (or samples read)
+    size_t intervals = 0;     // subintervals of the finest partition used
+    bool converged = false;
+};
+
+#endif // QUAD_RESULT_H_
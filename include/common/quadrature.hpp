@@ -0,0 +1,68 @@
+#ifndef QUADRATURE_H_
+#define QUADRATURE_H_
+
+#include <iostream>
+#include <type_traits>
+#include <valarray>
+#include "array_view.hpp"
+#include "reduce.hpp"
+#include "newton_cotes.hpp"
+
+using namespace std;
+
+/* The scalar type of the integrators is deduced from the step (or the
+ * interval) alone, so valarrays and vectors still convert to the
+ * sample view */
+template<class T>
+struct nondeduced {
+    typedef T type;
+};
+
+/* Composite rules on equally spaced samples f[i] = f(a + i*h), for
+ * T = float and double (instantiated in quadrature.cpp). Sums are
+ * accumulated in double through the reduce.hpp kernels. Both accept
+ * any number of samples (see integrate_nc() in newton_cotes.hpp). */
+template<class T>
+T integrate_trapezoid(array_view<const typename nondeduced<T>::type> f, T h);
+template<class T>
+T integrate_newton_cotes_4(array_view<const typename nondeduced<T>::type> f, T h);
+
+/* Integral of tabulated samples fi with spacing h, using the
+ * composite NCpoints-point Newton-Cotes rule (NCpoints in [2, 6]) */
+template<class T>
+T nintegrate1D(array_view<const typename nondeduced<T>::type> fi, T h, int NCpoints);
+
+/* Evaluation count from which nintegrate1D(a, b, func, ...) spreads
+ * the integrand evaluations over the default thread pool */
+const size_t NINTEGRATE_PARALLEL_MIN = size_t(1) << 16;
+
+/* Integral of func over [a, b] from N equally spaced evaluations
+ * (N-1 intervals) with the composite NCpoints-point rule. func can be
+ * any callable T(T); it is inlined into the summation loop, and the
+ * abscissae are computed in T. The evaluations are summed in fixed
+ * blocks and the block partials are combined in a fixed order, so the
+ * result is the same whether or not the blocks run in parallel (for
+ * N >= NINTEGRATE_PARALLEL_MIN, func must then be safe to call
+ * concurrently). */
+template<class T, class F>
+T nintegrate1D(T a, typename nondeduced<T>::type b, F func, size_t N, int NCpoints) {
+    static_assert(is_floating_point<T>::value, "nintegrate1D() integrates over a floating-point interval");
+    if (N < 2) return T(0);
+    CompositeWeights w(N, NCpoints);
+    if (w.size() == 0) return T(0);
+
+    T h = (b - a) / T(N - 1);
+    auto term = [&](size_t i) {
+        T x = (i == N - 1) ? b : a + T(i) * h;
+        return w(i) * double(func(x));
+    };
+
+    double sum = (N >= NINTEGRATE_PARALLEL_MIN) ? reduce_indexed(N, term, default_thread_pool())
+                                                : reduce_indexed(N, term);
+    return T(double(h) * sum);
+}
+
+/* Function-pointer form, kept for existing callers */
+double nintegrate1D(double a, double b, double (*func) (double x), size_t N, int NCpoints);
+
+#endif // QUADRATURE_H_
@@ -0,0 +1,138 @@
+#ifndef REDUCE_H_
+#define REDUCE_H_
+
+#include <cstddef>
+#include <vector>
+#include "array_view.hpp"
+#include "thread_pool.hpp"
+
+using namespace std;
+
+/* Reduction kernels for long float series.
+ *
+ * Storage stays in float, but every sum is accumulated in double:
+ * the terms of a block are spread round-robin over REDUCE_LANES
+ * independent double accumulators (which the compiler can keep in
+ * SIMD registers without reassociating anything), the lanes are
+ * added pairwise, and the per-block partials are combined by
+ * pairwise summation. The blocking depends only on the length of
+ * the series, so the serial and the threaded versions produce
+ * bitwise identical results for any number of threads. */
+
+const size_t REDUCE_LANES = 8;
+const size_t REDUCE_BLOCK = 4096;
+
+/* Sum of term(i) for i in [begin, end) using lane accumulators */
+template<class Term>
+inline double reduce_block(size_t begin, size_t end, Term& term) {
+    double lane[REDUCE_LANES] = {0.0};
+
+    size_t i = begin;
+    for (; i + REDUCE_LANES <= end; i += REDUCE_LANES) {
+        for (size_t l = 0; l < REDUCE_LANES; ++l) lane[l] += term(i + l);
+    }
+    for (size_t l = 0; i < end; ++i, ++l) lane[l] += term(i);
+
+    for (size_t width = REDUCE_LANES / 2; width > 0; width /= 2) {
+        for (size_t l = 0; l < width; ++l) lane[l] += lane[l + width];
+    }
+    return lane[0];
+}
+
+/* Pairwise sum of the block partials, in a fixed tree order */
+inline double reduce_partials(vector<double>& partial) {
+    if (partial.empty()) return 0.0;
+    for (size_t width = 1; width < partial.size(); width *= 2) {
+        for (size_t b = 0; b + width < partial.size(); b += 2 * width) {
+            partial[b] += partial[b + width];
+        }
+    }
+    return partial[0];
+}
+
+/* Sum of term(i), i = 0..n-1, where term returns the i-th summand */
+template<class Term>
+double reduce_indexed(size_t n, Term term) {
+    size_t nblocks = (n + REDUCE_BLOCK - 1) / REDUCE_BLOCK;
+    if (nblocks <= 1) return reduce_block(0, n, term);
+
+    vector<double> partial(nblocks);
+    for (size_t b = 0; b < nblocks; ++b) {
+        partial[b] = reduce_block(b * REDUCE_BLOCK, min(n, (b + 1) * REDUCE_BLOCK), term);
+    }
+    return reduce_partials(partial);
+}
+
+/* Same as above with the blocks spread over a thread pool */
+template<class Term>
+double reduce_indexed(size_t n, Term term, ThreadPool& pool) {
+    size_t nblocks = (n + REDUCE_BLOCK - 1) / REDUCE_BLOCK;
+    if (nblocks <= 1) return reduce_block(0, n, term);
+
+    vector<double> partial(nblocks);
+    parallel_for(pool, nblocks, 1, [&](size_t first, size_t last) {
+        Term local = term;
+        for (size_t b = first; b < last; ++b) {
+            partial[b] = reduce_block(b * REDUCE_BLOCK, min(n, (b + 1) * REDUCE_BLOCK), local);
+        }
+    });
+    return reduce_partials(partial);
+}
+
+/* sum_i f[i] */
+template<class T>
+double reduce_sum(array_view<const T> f) {
+    const T* p = f.data();
+    return reduce_indexed(f.size(), [p](size_t i) { return double(p[i]); });
+}
+
+/* sum_i f[i] * g[i] */
+template<class T>
+double reduce_dot(array_view<const T> f, array_view<const T> g) {
+    const T* p = f.data();
+    const T* q = g.data();
+    return reduce_indexed(f.size(), [p, q](size_t i) { return double(p[i]) * double(q[i]); });
+}
+
+/* sum_i w[i % period] * f[i]: composite quadrature weights repeat
+ * with the panel width, so a whole composite rule is one pass. The
+ * weights are laid out repeated over period * REDUCE_LANES (+ one lane
+ * group) entries and read at a running offset that wraps by a whole
+ * number of periods, so the lane loop is the same straight
+ * multiply-add as reduce_block() and i % period is taken only once per
+ * block. Blocks and lanes are those of reduce_indexed(). */
+template<class T>
+double reduce_periodic(array_view<const T> f, const double* w, size_t period) {
+    const T* p = f.data();
+    size_t n = f.size();
+    if (n == 0 || period == 0) return 0.0;
+
+    size_t span = period * REDUCE_LANES;
+    vector<double> wr(span + REDUCE_LANES);
+    for (size_t j = 0; j < wr.size(); ++j) wr[j] = w[j % period];
+
+    auto block = [p, &wr, span, period](size_t begin, size_t end) {
+        double lane[REDUCE_LANES] = {0.0};
+        const double* q = wr.data();
+        size_t i = begin, k = begin % period;
+        for (; i + REDUCE_LANES <= end; i += REDUCE_LANES) {
+            for (size_t l = 0; l < REDUCE_LANES; ++l) lane[l] += q[k + l] * double(p[i + l]);
+            k += REDUCE_LANES;
+            if (k >= span) k -= span;
+        }
+        for (size_t l = 0; i < end; ++i, ++l) lane[l] += q[k + l] * double(p[i]);
+
+        for (size_t width = REDUCE_LANES / 2; width > 0; width /= 2) {
+            for (size_t l = 0; l < width; ++l) lane[l] += lane[l + width];
+        }
+        return lane[0];
+    };
+
+    size_t nblocks = (n + REDUCE_BLOCK - 1) / REDUCE_BLOCK;
+    if (nblocks <= 1) return block(0, n);
+    vector<double> partial(nblocks);
+    for (size_t b = 0; b < nblocks; ++b) partial[b] = block(b * REDUCE_BLOCK, min(n, (b + 1) * REDUCE_BLOCK));
+    return reduce_partials(partial);
+}
+
+#endif // REDUCE_H_
@@ -0,0 +1,42 @@
+#ifndef RESAMPLE_H_
+#define RESAMPLE_H_
+
+#include <string>
+#include <valarray>
+#include <vector>
+
+using namespace std;
+
+/* How a stream is brought onto the common clock */
+enum class ResampleMode {
+    Linear,   // linear interpolation between the bracketing samples
+    Nearest,  // value of the closest sample in time
+    Average   // mean of the linear interpolant over the output frame
+              // [t - dt/2, t + dt/2]: a boxcar anti-aliasing filter
+              // for decimating fast streams (e.g. 100 Hz -> 5 Hz)
+};
+
+/* One timestamped input stream. Samples are stored row-major with
+ * nchan values per timestamp; timestamps must be strictly increasing
+ * but need not be uniform. */
+struct TimeStream {
+    string name;
+    valarray<float> t;
+    valarray<float> v;
+    size_t nchan = 1;
+    ResampleMode mode = ResampleMode::Linear;
+};
+
+/* Merged output: frame k holds the channels of all streams, in the
+ * order the streams were given, at time t[k]. Channels of a stream
+ * that does not cover t[k] are NaN. */
+struct FrameStream {
+    valarray<float> t;
+    valarray<float> v;
+    size_t nchan = 0;
+};
+
+/* Align the streams onto the clock t_k = t0 + k*dt, k < nframes */
+FrameStream align_streams(const vector<TimeStream>& streams, float t0, float dt, size_t nframes);
+
+#endif // RESAMPLE_H_
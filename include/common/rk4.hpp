@@ -0,0 +1,40 @@
+#ifndef RK4_H_
+#define RK4_H_
+
+#include <cstddef>
+
+using namespace std;
+
+/* Classical fourth-order Runge-Kutta for fixed-size states.
+ *
+ * State is std::array<T, n> or any fixed-size vector with value_type,
+ * size() and operator[]. The right-hand side has the output-parameter
+ * form rhs(t, y, dydt) and the stage vectors k1..k4 live on the stack,
+ * so a step does no heap allocation. */
+template<class State, class RHS>
+void rk4_step(RHS&& rhs, typename State::value_type t, State& y, typename State::value_type h) {
+    using T = typename State::value_type;
+    const size_t n = y.size();
+    const T h2 = h / T(2);
+    State k1, k2, k3, k4, ytmp;
+
+    rhs(t, y, k1);
+    for (size_t i = 0; i < n; ++i) ytmp[i] = y[i] + h2 * k1[i];
+    rhs(t + h2, ytmp, k2);
+    for (size_t i = 0; i < n; ++i) ytmp[i] = y[i] + h2 * k2[i];
+    rhs(t + h2, ytmp, k3);
+    for (size_t i = 0; i < n; ++i) ytmp[i] = y[i] + h * k3[i];
+    rhs(t + h, ytmp, k4);
+
+    // Update y using the weighted average of slopes
+    for (size_t i = 0; i < n; ++i) y[i] += h / T(6) * (k1[i] + T(2) * k2[i] + T(2) * k3[i] + k4[i]);
+}
+
+/* N steps of size h from (t0, y), y is advanced in place */
+template<class State, class RHS>
+void rk4_steps(RHS&& rhs, typename State::value_type t0, State& y, typename State::value_type h, int N) {
+    using T = typename State::value_type;
+    for (int i = 0; i < N; ++i) rk4_step(rhs, t0 + T(i) * h, y, h);
+}
+
+#endif // RK4_H_
@@ -0,0 +1,148 @@
+#ifndef ROMBERG_H_
+#define ROMBERG_H_
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <vector>
+#include "array_view.hpp"
+#include "newton_cotes.hpp"
+#include "quad_result.hpp"
+#include "reduce.hpp"
+
+using namespace std;
+
+/* Richardson extrapolation of the trapezoid sums T[0..K] (step
+ * halving from T[k-1] to T[k]):
+ *   R[k][j] = R[k][j-1] + (R[k][j-1] - R[k-1][j-1]) / (4^j - 1)
+ * Returns R[K][K]; the error estimate is the larger change between
+ * the last two diagonal and the last two row entries. */
+inline double richardson(const vector<double>& T, double& error) {
+    size_t K = T.size() - 1;
+    vector<double> prev(T.size()), row(T.size());
+    prev[0] = T[0];
+    error = 0.0;
+    for (size_t k = 1; k <= K; ++k) {
+        row[0] = T[k];
+        double p4 = 1.0;
+        for (size_t j = 1; j <= k; ++j) {
+            p4 *= 4.0;
+            row[j] = row[j - 1] + (row[j - 1] - prev[j - 1]) / (p4 - 1.0);
+        }
+        if (k == K) error = max(fabs(row[K] - prev[K - 1]), fabs(row[K] - row[K - 1]));
+        swap(prev, row);
+    }
+    return prev[K];
+}
+
+/* Romberg integral of equally spaced samples f (spacing h).
+ *
+ * The trapezoid estimates of stride 2^K, 2^(K-1), ..., 1 are built in
+ * a single pass over the array: sample i belongs to refinement level
+ * K - min(tz(i), K), where tz(i) is the number of trailing zero bits
+ * of i, so each level only adds the midpoints it introduces and no
+ * sample is read twice. K is at most max_levels-1 and leaves at least
+ * four intervals on the coarsest grid. Samples past the last multiple
+ * of 2^K (fewer than 2^K intervals, possibly a single one) are
+ * integrated with the composite Boole rule over a window reaching 8-12
+ * intervals back into the extrapolated part, minus that overlap, so a
+ * short tail still gets a high-order rule; its difference to the same
+ * construction with Simpson's rule is added to the error estimate.
+ * The result is converged when the total error estimate is within
+ * max(abs_tol, rel_tol * |I|). */
+template<class T>
+QuadResult romberg(array_view<const T> f, double h, double abs_tol = 0.0, double rel_tol = 1e-6,
+                   int max_levels = 6) {
+    QuadResult res;
+    size_t n = f.size();
+    res.evaluations = n;
+    if (n < 2) {
+        res.converged = true;
+        return res;
+    }
+
+    size_t intervals = n - 1;
+    size_t K = 0;
+    while (K + 1 < size_t(max(max_levels, 1)) && (intervals >> (K + 1)) >= 4) K++;
+    if (K == 0) {
+        /* too short to extrapolate; with a single interval both rules
+         * are the trapezoid and there is no error estimate */
+        res.value = integrate_nc<5, T>(f, h);
+        res.error = fabs(res.value - integrate_nc<2, T>(f, h));
+        res.intervals = intervals;
+        res.converged = intervals > 1 && res.error <= max(abs_tol, rel_tol * fabs(res.value));
+        return res;
+    }
+    size_t P = (intervals >> K) << K;
+
+    /* One pass: per-level sums of the newly introduced samples */
+    vector<double> S(K + 1, 0.0);
+    for (size_t i = 1; i < P; ++i) {
+        size_t tz = 0;
+        while (tz < K && ((i >> tz) & 1) == 0) tz++;
+        S[K - tz] += double(f[i]);
+    }
+
+    vector<double> Tk(K + 1);
+    double H = h * double(size_t(1) << K);
+    Tk[0] = H * (0.5 * double(f[0]) + 0.5 * double(f[P]) + S[0]);
+    for (size_t k = 1; k <= K; ++k) {
+        H *= 0.5;
+        Tk[k] = 0.5 * Tk[k - 1] + H * S[k];
+    }
+
+    double error;
+    res.value = richardson(Tk, error);
+
+    if (P < intervals) {
+        /* P >= 8. An overlap of whole Boole (and Simpson) panels
+         * lets both composite rules fold a tail of any length into
+         * rules of their own order, see nc_split() */
+        size_t back = (P >= 12) ? 12 : 8;
+        array_view<const T> window = f.subview(P - back, n - P + back);
+        array_view<const T> overlap = f.subview(P - back, back + 1);
+        double boole = integrate_nc<5, T>(window, h) - integrate_nc<5, T>(overlap, h);
+        double simpson = integrate_nc<3, T>(window, h) - integrate_nc<3, T>(overlap, h);
+        res.value += boole;
+        error += fabs(boole - simpson);
+    }
+
+    res.error = error;
+    res.intervals = intervals;
+    res.converged = error <= max(abs_tol, rel_tol * fabs(res.value));
+    return res;
+}
+
+/* Romberg integral of a callable f over [a, b]: each level evaluates
+ * only the 2^(k-1) new midpoints, until the extrapolated value changes
+ * by less than max(abs_tol, rel_tol * |I|) or max_levels is reached */
+template<class F>
+QuadResult romberg(F f, double a, double b, double abs_tol, double rel_tol = 0.0, int max_levels = 20) {
+    QuadResult res;
+    vector<double> Tk;
+    Tk.push_back(0.5 * (b - a) * (double(f(a)) + double(f(b))));
+    res.evaluations = 2;
+
+    size_t nmid = 1;
+    double H = b - a;
+    for (int k = 1; k < max_levels; ++k) {
+        double hk = 0.5 * H;
+        double sum = reduce_indexed(nmid, [&](size_t i) { return double(f(a + (2.0 * double(i) + 1.0) * hk)); });
+        Tk.push_back(0.5 * Tk.back() + hk * sum);
+        res.evaluations += nmid;
+        H = hk;
+        nmid *= 2;
+
+        double error;
+        res.value = richardson(Tk, error);
+        res.error = error;
+        res.intervals = nmid;
+        if (k >= 3 && error <= max(abs_tol, rel_tol * fabs(res.value))) {
+            res.converged = true;
+            return res;
+        }
+    }
+    return res;
+}
+
+#endif // ROMBERG_H_
@@ -0,0 +1,40 @@
+#ifndef SHOT_SENSITIVITY_H_
+#define SHOT_SENSITIVITY_H_
+
+#include "ensemble.hpp"
+
+using namespace std;
+
+/* Launch parameters, as bit flags for selecting subsets */
+enum ShotParameter : unsigned {
+    SHOT_SPEED = 1u,
+    SHOT_ELEVATION = 2u,
+    SHOT_AZIMUTH = 4u,
+    SHOT_SPIN = 8u,
+    SHOT_DRAG = 16u     // drag_scale, i.e. C_DRAG relative to its nominal value
+};
+
+const int SHOT_NPARAM = 5;
+
+/* Crossing of one shot (goal line or ground, as in ensemble.hpp) and
+ * the derivatives of the crossing time and position with respect to
+ * the requested parameters, indexed like the flags (0 = speed, ...,
+ * 4 = drag scale); entries of parameters not requested are zero. */
+struct ShotSensitivity {
+    ShotResult hit;
+    double dt[SHOT_NPARAM] = {0.0};
+    double dx[SHOT_NPARAM] = {0.0};
+    double dy[SHOT_NPARAM] = {0.0};
+    double dz[SHOT_NPARAM] = {0.0};
+};
+
+/* One RK4 integration in forward-mode dual numbers (dual.hpp) with a
+ * derivative slot per requested parameter, through the same force
+ * model as q4 (ball_forces.hpp), in double precision. The crossing is
+ * located on the step's Hermite interpolant and differentiated through
+ * the implicit function theorem, dt/dp = -(dg/dp) / (dg/dt), so the
+ * Jacobian is exact for the discretised trajectory and free of the
+ * step-size noise of finite differences. */
+ShotSensitivity shot_sensitivity(const ShotLaunch& launch, unsigned params, float dt, const BallPhysics& physics);
+
+#endif // SHOT_SENSITIVITY_H_
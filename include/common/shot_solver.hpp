@@ -0,0 +1,57 @@
+#ifndef SHOT_SOLVER_H_
+#define SHOT_SOLVER_H_
+
+#include <vector>
+#include "ensemble.hpp"
+#include "shot_sensitivity.hpp"
+#include "thread_pool.hpp"
+
+using namespace std;
+
+/* Inverse shot solver: launch parameters that make the ball centre
+ * cross the goal line (x = PITCH_L/2) at a target (y, z).
+ *
+ * Any subset of {speed, elevation, azimuth, spin, drag} is free, the
+ * rest stay at the initial guess. The shooting problem r(p) =
+ * crossing(p) - target is solved by Levenberg-Marquardt: the damped
+ * normal equations (J^T J + lambda diag(J^T J)) dp = -J^T r give the
+ * step. Every trial point is integrated once, in dual numbers
+ * (shot_sensitivity.hpp), so residuals are always compared within the
+ * same integrator and an accepted trial already carries the crossing
+ * and Jacobian of the next iteration. With fewer free parameters than
+ * 2 the solution is the least-squares fit, with more the damping
+ * picks a small step.
+ *
+ * A shot that lands short of the goal line has its residual continued
+ * past the ground: the remaining distance to the goal line counts as
+ * height below the ground, so the solver can climb out of WEAK
+ * territory instead of failing. */
+
+/* Crossing point of the ball centre on the goal plane, in m */
+struct ShotTarget {
+    float y, z;
+};
+
+struct InverseShotOptions {
+    unsigned free_params = SHOT_ELEVATION | SHOT_AZIMUTH;
+    float dt = 0.01f;
+    BallPhysics physics;
+    double tolerance = 1e-3;   // on |crossing - target| in m
+    int max_iterations = 40;
+};
+
+struct InverseShotResult {
+    ShotLaunch launch;         // solved launch parameters
+    ShotResult hit;            // simulated crossing of that launch
+    double residual = 0.0;     // |crossing - target| in m
+    int iterations = 0;
+    bool converged = false;
+};
+
+InverseShotResult solve_shot(const ShotLaunch& guess, const ShotTarget& target, const InverseShotOptions& options);
+
+/* Solve every target from the same initial guess, one task per target */
+vector<InverseShotResult> solve_shots(const ShotLaunch& guess, const vector<ShotTarget>& targets,
+                                      const InverseShotOptions& options, ThreadPool& pool);
+
+#endif // SHOT_SOLVER_H_
@@ -0,0 +1,191 @@
+#ifndef SHOT_SURROGATE_H_
+#define SHOT_SURROGATE_H_
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "ensemble.hpp"
+#include "thread_pool.hpp"
+
+using namespace std;
+
+/* Precomputed goal-line crossings of the shots from one launch spot,
+ * tabulated over (speed, elevation, azimuth, spin_z) and queried by
+ * 4-D multilinear interpolation: 16 node loads and a few dozen flops
+ * per query instead of a full trajectory integration.
+ *
+ * Every node stores the crossing time t, the crossing point y, the
+ * continued height z (a shot that lands short counts the remaining
+ * distance to the goal line as height below the ground, as in
+ * shot_solver.hpp, which keeps z continuous across the GOOD/WEAK
+ * boundary) and the error bound of the cell it is the lower corner
+ * of. The outcome of a query follows from the interpolated z.
+ *
+ * Error bound of a cell: multilinear interpolation of a C^2 function
+ * is off by at most 1/8 sum_d h_d^2 max|d^2f/dx_d^2| over the cell.
+ * h_d^2 f_dd is estimated by the second difference along axis d at
+ * each of the 16 corners; the largest corner sum, with a safety
+ * factor for kinks, is stored. The table is then checked against
+ * direct integration at random points and the result recorded in the
+ * header.
+ *
+ * File layout: SurrogateHeader, then the nodes from data_offset as a
+ * flat row-major [speed][elevation][azimuth][spin] array of
+ * SurrogateNode (native byte order), so open() can map the file and
+ * query it in place. The table is built with the ensemble integrator
+ * (ensemble.hpp): fixed-step RK4 on ForceModel<Gravity, Drag,
+ * Magnus<SpinZ>> of ball_forces.hpp, the force model of the q4 shot,
+ * with drag and Magnus as selected by BallPhysics. */
+
+struct SurrogateAxis {
+    float lo = 0.0f, hi = 0.0f;
+    uint32_t n = 2;
+    float step() const { return (hi - lo) / float(n - 1); }
+};
+
+/* Axes in the order speed (m/s), elevation (rad), azimuth (rad),
+ * spin_z (rad/s) */
+struct SurrogateGrid {
+    SurrogateAxis axis[4];
+};
+
+/* Default grid around the Q4 shot: 10-40 m/s, 2-45 deg elevation,
+ * +-30 deg azimuth, +-20 rad/s spin */
+SurrogateGrid default_surrogate_grid();
+
+struct SurrogateNode {
+    float t, y, z;
+    float err_t, err_y, err_z;  // bound of the cell with this lower corner
+};
+
+struct SurrogateHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t physics;           // bit 0 drag, bit 1 Magnus
+    SurrogateGrid grid;
+    ShotLaunch origin;          // launch spot (x, y, z and drag_scale are used)
+    float dt;                   // RK4 step of the tabulated shots
+    float z_ground, z_bar;      // ball centre on the ground / at the crossbar
+    uint64_t nodes;
+    uint64_t data_offset;       // byte offset of the node array
+
+    /* check against direct integration at uniformly random points */
+    uint32_t validation_samples;
+    uint32_t bound_violations;  // samples off by more than the stated bound
+    uint32_t uncertain_outcomes;
+    uint32_t outcome_mismatches;    // wrong outcomes among the certain ones
+    float max_error_t, max_error_y, max_error_z;
+};
+
+/* Interpolated crossing. outcome_certain is false when the outcome
+ * threshold (ground or crossbar) lies within the error bound of z;
+ * in_range is false when a parameter was clamped to the grid. */
+struct SurrogateHit {
+    ShotOutcome outcome = ShotOutcome::Unresolved;
+    float t = 0.0f, y = 0.0f, z = 0.0f;
+    float err_t = 0.0f, err_y = 0.0f, err_z = 0.0f;
+    bool outcome_certain = false;
+    bool in_range = false;
+};
+
+class ShotSurrogate {
+public:
+    ShotSurrogate() = default;
+    ~ShotSurrogate() { close(); }
+
+    ShotSurrogate(const ShotSurrogate&) = delete;
+    ShotSurrogate& operator=(const ShotSurrogate&) = delete;
+
+    /* Tabulate the grid in memory, then validate it at
+     * validation_samples random points */
+    void build(const SurrogateGrid& grid, const ShotLaunch& origin, float dt, const BallPhysics& physics,
+               ThreadPool& pool, size_t validation_samples = 4096);
+
+    bool save(const string& filename) const;
+
+    /* Map (or, without mmap, read) a table written by save() */
+    bool open(const string& filename);
+    void close();
+
+    bool empty() const { return node == nullptr; }
+    const SurrogateHeader& header() const { return head; }
+    BallPhysics physics() const;
+
+    SurrogateHit query(float speed, float elevation, float azimuth, float spin_z) const;
+
+private:
+    void index();
+
+    SurrogateHeader head{};
+    const SurrogateNode* node = nullptr;
+    vector<SurrogateNode> owned;    // built or read tables
+    void* mapped = nullptr;         // mapped tables
+    size_t mapped_size = 0;
+
+    size_t stride[4] = {0, 0, 0, 0};
+    float inv_step[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+};
+
+/* Outcome of a continued goal-plane height z (ball centre) */
+inline ShotOutcome surrogate_outcome(float z, float z_ground, float z_bar) {
+    if (!(z == z)) return ShotOutcome::Unresolved;
+    if (z < z_ground) return ShotOutcome::Weak;
+    return (z <= z_bar) ? ShotOutcome::Good : ShotOutcome::Over;
+}
+
+inline SurrogateHit ShotSurrogate::query(float speed, float elevation, float azimuth, float spin_z) const {
+    SurrogateHit hit;
+    if (!node) return hit;
+
+    const float q[4] = {speed, elevation, azimuth, spin_z};
+    float w[4];
+    size_t base = 0;
+    hit.in_range = true;
+    for (int d = 0; d < 4; ++d) {
+        const SurrogateAxis& a = head.grid.axis[d];
+        float u = (q[d] - a.lo) * inv_step[d];
+        float umax = float(a.n - 1);
+        if (!(u >= 0.0f)) {
+            u = 0.0f;
+            hit.in_range = false;
+        } else if (u > umax) {
+            u = umax;
+            hit.in_range = false;
+        }
+        size_t i = min(size_t(u), size_t(a.n - 2));
+        w[d] = u - float(i);
+        base += i * stride[d];
+    }
+
+    /* Pairs of nodes along spin (adjacent in memory) for the 8
+     * corners of the (speed, elevation, azimuth) cell */
+    const float ws = w[3], vs = 1.0f - w[3];
+    float t = 0.0f, y = 0.0f, z = 0.0f;
+    for (unsigned c = 0; c < 8; ++c) {
+        float wc = ((c & 1u) ? w[0] : 1.0f - w[0]) * ((c & 2u) ? w[1] : 1.0f - w[1]) *
+                   ((c & 4u) ? w[2] : 1.0f - w[2]);
+        const SurrogateNode* p = node + base + ((c & 1u) ? stride[0] : 0) + ((c & 2u) ? stride[1] : 0) +
+                                 ((c & 4u) ? stride[2] : 0);
+        t += wc * (vs * p[0].t + ws * p[1].t);
+        y += wc * (vs * p[0].y + ws * p[1].y);
+        z += wc * (vs * p[0].z + ws * p[1].z);
+    }
+
+    const SurrogateNode& cell = node[base];
+    hit.t = t;
+    hit.y = y;
+    hit.z = z;
+    hit.err_t = cell.err_t;
+    hit.err_y = cell.err_y;
+    hit.err_z = cell.err_z;
+
+    hit.outcome = surrogate_outcome(z, head.z_ground, head.z_bar);
+    hit.outcome_certain = hit.outcome != ShotOutcome::Unresolved && fabs(z - head.z_ground) > cell.err_z &&
+                          fabs(z - head.z_bar) > cell.err_z;
+    return hit;
+}
+
+#endif // SHOT_SURROGATE_H_
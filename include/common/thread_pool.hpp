@@ -0,0 +1,221 @@
+#ifndef THREAD_POOL_H_
+#define THREAD_POOL_H_
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+/* Work-stealing thread pool.
+ *
+ * Every worker owns a task deque. A worker pops from the back of its
+ * own deque (most recently pushed work, still warm in cache) and,
+ * once that is empty, steals from the front of the other deques
+ * (oldest work first). Tasks submitted from inside a worker go to
+ * that worker's deque; tasks submitted from outside are spread
+ * round-robin over all deques.
+ *
+ * A thread that waits on pool work (wait_idle(), parallel_for())
+ * keeps executing pending tasks while it waits, so nested parallel
+ * sections cannot deadlock the pool. */
+class ThreadPool {
+public:
+    explicit ThreadPool(size_t nthreads = 0) : queues(nthreads ? nthreads : default_size()) {
+        for (size_t i = 0; i < queues.size(); ++i) {
+            workers.emplace_back([this, i] { worker_loop(i); });
+        }
+    }
+
+    ~ThreadPool() {
+        {
+            lock_guard<mutex> lock(wake_mutex);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (thread& w : workers) w.join();
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    size_t size() const { return queues.size(); }
+
+    /* Schedule f() and return a future for its result */
+    template<class F>
+    auto submit(F&& f) -> future<decltype(f())> {
+        using R = decltype(f());
+        auto task = make_shared<packaged_task<R()> >(std::forward<F>(f));
+        future<R> result = task->get_future();
+        push([task] { (*task)(); });
+        return result;
+    }
+
+    /* Run one pending task on the calling thread, if there is any */
+    bool run_pending_task() {
+        function<void()> task;
+        size_t self = (current_pool() == this) ? current_index() : next_queue.load() % size();
+        if (!pop_or_steal(self, task)) return false;
+        execute(task);
+        return true;
+    }
+
+    /* Block until every task submitted so far has finished */
+    void wait_idle() {
+        while (pending.load() != 0) {
+            if (!run_pending_task()) this_thread::yield();
+        }
+    }
+
+private:
+    struct TaskQueue {
+        mutex m;
+        deque<function<void()> > tasks;
+    };
+
+    static size_t default_size() {
+        unsigned n = thread::hardware_concurrency();
+        return n ? n : 1;
+    }
+
+    static const ThreadPool*& current_pool() {
+        static thread_local const ThreadPool* pool = nullptr;
+        return pool;
+    }
+
+    static size_t& current_index() {
+        static thread_local size_t index = 0;
+        return index;
+    }
+
+    void push(function<void()> task) {
+        size_t q = (current_pool() == this) ? current_index() : next_queue++ % size();
+        pending++;
+        {
+            /* Count the task before it becomes visible: a worker that
+             * pops it at once must not take queued below zero */
+            lock_guard<mutex> lock(wake_mutex);
+            queued++;
+            lock_guard<mutex> queue_lock(queues[q].m);
+            queues[q].tasks.push_back(std::move(task));
+        }
+        wake.notify_one();
+    }
+
+    /* Pop from the back of our own deque, else steal from the front
+     * of the others, starting with our right-hand neighbour */
+    bool pop_or_steal(size_t self, function<void()>& task) {
+        {
+            lock_guard<mutex> lock(queues[self].m);
+            if (!queues[self].tasks.empty()) {
+                task = std::move(queues[self].tasks.back());
+                queues[self].tasks.pop_back();
+                return true;
+            }
+        }
+        for (size_t k = 1; k < size(); ++k) {
+            TaskQueue& victim = queues[(self + k) % size()];
+            lock_guard<mutex> lock(victim.m);
+            if (!victim.tasks.empty()) {
+                task = std::move(victim.tasks.front());
+                victim.tasks.pop_front();
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /* Finishes a task on every exit of execute(), also when it throws,
+     * so that wait_idle() cannot wait for it forever */
+    struct PendingGuard {
+        atomic<size_t>& count;
+        ~PendingGuard() { count--; }
+    };
+
+    void execute(function<void()>& task) {
+        {
+            lock_guard<mutex> lock(wake_mutex);
+            queued--;
+        }
+        PendingGuard done{pending};
+        task();
+    }
+
+    void worker_loop(size_t index) {
+        current_pool() = this;
+        current_index() = index;
+
+        function<void()> task;
+        for (;;) {
+            if (pop_or_steal(index, task)) {
+                execute(task);
+                continue;
+            }
+            unique_lock<mutex> lock(wake_mutex);
+            wake.wait(lock, [this] { return stopping || queued > 0; });
+            if (stopping && queued == 0) return;
+        }
+    }
+
+    vector<TaskQueue> queues;
+    vector<thread> workers;
+
+    mutex wake_mutex;
+    condition_variable wake;
+    size_t queued = 0;        // tasks sitting in a deque (guarded by wake_mutex)
+    bool stopping = false;
+
+    atomic<size_t> pending{0};   // tasks submitted but not yet finished
+    atomic<size_t> next_queue{0};
+};
+
+/* Process-wide pool sized to the hardware concurrency */
+inline ThreadPool& default_thread_pool() {
+    static ThreadPool pool;
+    return pool;
+}
+
+/* Call body(begin, end) over [0, n) split into chunks of at most
+ * `grain` indices. The chunk boundaries depend only on n and grain,
+ * never on the number of threads, so callers that reduce per chunk
+ * and combine the partials in chunk order get identical results on
+ * any machine. The calling thread helps until all chunks are done. */
+template<class Body>
+void parallel_for(ThreadPool& pool, size_t n, size_t grain, Body body) {
+    if (n == 0) return;
+    if (grain == 0) grain = 1;
+    size_t nchunks = (n + grain - 1) / grain;
+    if (nchunks == 1 || pool.size() == 1) {
+        for (size_t c = 0; c < nchunks; ++c) body(c * grain, min(n, (c + 1) * grain));
+        return;
+    }
+
+    atomic<size_t> remaining{nchunks};
+    exception_ptr error;
+    mutex error_mutex;
+    for (size_t c = 0; c < nchunks; ++c) {
+        pool.submit([&, c] {
+            try {
+                body(c * grain, min(n, (c + 1) * grain));
+            } catch (...) {
+                lock_guard<mutex> lock(error_mutex);
+                if (!error) error = current_exception();
+            }
+            remaining--;
+        });
+    }
+    while (remaining.load() != 0) {
+        if (!pool.run_pending_task()) this_thread::yield();
+    }
+    if (error) rethrow_exception(error);
+}
+
+#endif // THREAD_POOL_H_
@@ -0,0 +1,14 @@
+#ifndef TRACKING_H_
+#define TRACKING_H_
+
+#include <iostream>
+#include <string>
+#include <valarray>
+#include <vector>
+
+using namespace std;
+
+/* Read a "t x y" tracking file into one valarray of size N*3 */
+valarray<float> read_tracking_data(const string& filename);
+
+#endif // TRACKING_H_
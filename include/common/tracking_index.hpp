@@ -0,0 +1,47 @@
+#ifndef TRACKING_INDEX_H_
+#define TRACKING_INDEX_H_
+
+#include <cstdint>
+#include <string>
+#include <valarray>
+#include <vector>
+
+using namespace std;
+
+/* Sidecar index of a "t x y" tracking file that maps time to the
+ * byte offset of a frame, so that a time window can be read without
+ * parsing the file from the start.
+ *
+ * The byte offset of every `block`-th frame is stored. For a constant
+ * frame rate the frame of time t follows from uniform arithmetic
+ * (as in locate()); otherwise the block is found by bisection over
+ * the block start times. Either way the loader seeks to the block
+ * and skips at most block-1 lines. */
+struct TrackingIndex {
+    uint64_t file_size = 0;     // size of the indexed file, to detect
+    int64_t file_mtime = 0;     // a stale sidecar
+    uint64_t frames = 0;
+    uint64_t block = 256;       // frames per index entry
+    bool uniform = false;       // constant frame rate
+    float t_first = 0.0f;       // timestamp of frame 0
+    float dt = 0.0f;            // frame period when uniform
+    vector<uint64_t> offset;    // byte offset of frame k*block
+    valarray<float> t_block;    // timestamp of frame k*block
+};
+
+/* Scan a tracking file once and build its index */
+TrackingIndex build_tracking_index(const string& filename, uint64_t block = 256);
+
+bool save_tracking_index(const string& idxfile, const TrackingIndex& idx);
+bool load_tracking_index(const string& idxfile, TrackingIndex& idx);
+
+/* Load <filename>.idx if it matches the file, otherwise (re)build
+ * the index and write the sidecar */
+TrackingIndex open_tracking_index(const string& filename);
+
+/* Read only the frames with t0 <= t <= t1, in the same N*3 layout as
+ * read_tracking_data() */
+valarray<float> read_tracking_window(const string& filename, const TrackingIndex& idx,
+                                     float t0, float t1);
+
+#endif // TRACKING_INDEX_H_
@@ -0,0 +1,178 @@
+#ifndef TRAJECTORY_RECORDER_H_
+#define TRAJECTORY_RECORDER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+/* Trajectory output of the ODE loops, decoupled from the integration.
+ *
+ * A TrajectoryRecorder decides WHICH states are written, by policy:
+ *   None       nothing
+ *   EveryStep  every k-th integration step (k = 1: every step)
+ *   Events     start, end and the interior events the caller reports
+ *   Resample   a fixed output rate, from the step interpolant (dense
+ *              output or cubic Hermite), independent of the step size
+ * and its sinks decide HOW: buffered text ("t y0 y1 ...", the format
+ * of the original q4 output) or a binary record stream of float rows.
+ * Console echo is just another text sink on cout, added only when
+ * asked for. A row is t followed by the state after the recorder's
+ * map (e.g. the height above the ground instead of the ball centre). */
+
+/* Destination of recorded rows of `columns` floats */
+class TrajectorySink {
+public:
+    virtual ~TrajectorySink() {}
+    virtual void write(const float* row, size_t columns) = 0;
+    virtual void flush() {}
+};
+
+/* Text rows with "%g" formatting, collected in a buffer and written in
+ * blocks instead of one formatted stream insertion per value */
+class TextTrajectorySink : public TrajectorySink {
+public:
+    explicit TextTrajectorySink(ostream& os, size_t buffer_bytes = size_t(1) << 16);
+    ~TextTrajectorySink() override;
+
+    void write(const float* row, size_t columns) override;
+    void flush() override;
+
+private:
+    ostream& out;
+    string buffer;
+    size_t capacity;
+};
+
+/* Binary stream: TrajectoryFileHeader, then rows of `columns` native
+ * floats; read back with read_trajectory_binary() */
+struct TrajectoryFileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t columns;
+};
+
+class BinaryTrajectorySink : public TrajectorySink {
+public:
+    BinaryTrajectorySink(ostream& os, size_t columns);
+    ~BinaryTrajectorySink() override;
+
+    void write(const float* row, size_t columns) override;
+    void flush() override;
+
+private:
+    ostream& out;
+    vector<float> buffer;
+};
+
+/* Rows of a binary trajectory file, row-major; false if the file is
+ * not one */
+bool read_trajectory_binary(const string& filename, vector<float>& rows, size_t& columns);
+
+struct RecordPolicy {
+    enum Mode { None, EveryStep, Events, Resample };
+    Mode mode = EveryStep;
+    int every = 1;          // EveryStep: write every k-th step
+    double rate_dt = 0.01;  // Resample: output interval
+
+    static RecordPolicy none() { return RecordPolicy{None, 1, 0.0}; }
+    static RecordPolicy every_step(int k = 1) { return RecordPolicy{EveryStep, k, 0.0}; }
+    static RecordPolicy events() { return RecordPolicy{Events, 1, 0.0}; }
+    static RecordPolicy resample(double dt) { return RecordPolicy{Resample, 1, dt}; }
+};
+
+/* Parse "none", "every:K" (or "every"), "events" or "rate:DT";
+ * returns false on anything else */
+bool parse_record_policy(const string& spec, RecordPolicy& policy);
+
+/* States written as they are */
+struct Unmapped {
+    template<class State>
+    void operator()(State&) const {}
+};
+
+template<class State, class Map = Unmapped>
+class TrajectoryRecorder {
+public:
+    using T = typename State::value_type;
+
+    explicit TrajectoryRecorder(const RecordPolicy& policy, Map map = Map()) : pol(policy), mapping(map) {
+        if (pol.every < 1) pol.every = 1;
+    }
+
+    void add_sink(TrajectorySink& sink) { sinks.push_back(&sink); }
+    bool enabled() const { return pol.mode != RecordPolicy::None && !sinks.empty(); }
+
+    /* Start and end points of the run: written by every policy but
+     * None, unless the last row already is at t (an end point that
+     * coincides with a recorded step). The first call sets the origin
+     * of the Resample grid. */
+    void boundary(T t, const State& y) {
+        if (!started) {
+            t_start = t;
+            started = true;
+        }
+        if (pol.mode != RecordPolicy::None && !(n_rows > 0 && t == t_last)) write(t, y);
+    }
+
+    /* Interior event (apex, crossing, ...): written by Events only */
+    void event(T t, const State& y) {
+        if (pol.mode == RecordPolicy::Events) write(t, y);
+    }
+
+    /* After a step ending at t1 with state y1; interp(s, y) evaluates
+     * the step's interpolant for s in the step. With partial = true the
+     * run ends inside this step at t1 (a terminal event): Resample then
+     * writes the grid points before t1 and EveryStep nothing, and the
+     * end point itself comes from boundary(). */
+    template<class Interp>
+    void step(T t1, const State& y1, Interp&& interp, bool partial = false) {
+        if (!enabled()) return;
+        if (pol.mode == RecordPolicy::EveryStep) {
+            if (!partial && ++steps % pol.every == 0) write(t1, y1);
+        } else if (pol.mode == RecordPolicy::Resample) {
+            State y;
+            for (;;) {
+                T tk = t_start + T(next + 1) * T(pol.rate_dt);
+                if (partial ? !(tk < t1) : !(tk <= t1)) break;
+                next++;
+                interp(tk, y);
+                write(tk, y);
+            }
+        }
+    }
+
+    void flush() {
+        for (TrajectorySink* s : sinks) s->flush();
+    }
+
+    size_t rows() const { return n_rows; }
+
+private:
+    void write(T t, State y) {
+        mapping(y);
+        row.resize(1 + y.size());
+        row[0] = float(t);
+        for (size_t i = 0; i < y.size(); ++i) row[1 + i] = float(y[i]);
+        for (TrajectorySink* s : sinks) s->write(row.data(), row.size());
+        t_last = t;
+        n_rows++;
+    }
+
+    RecordPolicy pol;
+    Map mapping;
+    vector<TrajectorySink*> sinks;
+    vector<float> row;    // t and the mapped state, reused
+    bool started = false;
+    T t_start = T(0);
+    T t_last = T(0);      // time of the last row written
+    size_t steps = 0;     // EveryStep: steps so far
+    size_t next = 0;      // Resample: grid points written
+    size_t n_rows = 0;
+};
+
+#endif // TRAJECTORY_RECORDER_H_
@@ -8,38 +8,48 @@
 #include <string>
 #include <sstream>
 #include <fstream>
+#include <array>
+#include "quadrature.hpp"
+#include "rk4.hpp"
+
+/* Pitch dimensions and physical constants are typed constexpr values
+ * (double, except the float flight-time bound). Code in another scalar
+ * type converts them once, e.g. T(A_GRAV) in templates, so float
+ * arithmetic is not promoted to double. */
 
 /* Pitch dimensions */
 
-#define PITCH_L 100.0 // Football pitch length in meters
-#define PITCH_W 64.0  // Football pitch width in meters
-#define GOAL_W 7.32   // Goal width in meters (distance between inner sides of posts)
-#define GOAL_H 2.44   // Goal height in meters (from ground to lower side of post)
+constexpr double PITCH_L = 100.0; // Football pitch length in meters
+constexpr double PITCH_W = 64.0;  // Football pitch width in meters
+constexpr double GOAL_W = 7.32;   // Goal width in meters (distance between inner sides of posts)
+constexpr double GOAL_H = 2.44;   // Goal height in meters (from ground to lower side of post)
 
 /* Definitions of constants */
 
-#define A_GRAV 9.812   // Acceleration of gravity in m/s^2
-#define R_BALL 0.111   // Football's radius in meters
-#define M_BALL 0.436   // Football's mass in kg
+constexpr double A_GRAV = 9.812;  // Acceleration of gravity in m/s^2
+constexpr double R_BALL = 0.111;  // Football's radius in meters
+constexpr double M_BALL = 0.436;  // Football's mass in kg
+
+constexpr double C_DRAG = 0.473;  // Drag coefficient (dimensionless)
+constexpr double S_MAGN = 0.002;  // Magnus coefficient (dimensionless)
+constexpr double RHO_AIR = 1.22;  // Air density in kg/m^3
+
+constexpr double OMEGA_Z = 10.0;  // Default spin about the z-axis in rad/s
 
-#define C_DRAG 0.473   // Drag coefficient (dimensionless)
-#define S_MAGN 0.002   // Magnus coefficient (dimensionless)
-#define RHO_AIR 1.22   // Air density in kg/m^3
+constexpr float T_FLIGHT_MAX = 20.0f; // Upper bound on the simulated flight time in s
 
 
 using namespace std;
 
-static float omega[3] = {0.0, 0.0, 10.0}; // Angular velocity along the z-axis in rad/s
-static bool drag_on = true;      // Flag that activates the effect of air resistance (drag force)
-static bool magnus_on = true;    // Flag that activates the Magnus effect (curving)
+/* The force model (which of drag and Magnus are on, spin vector)
+ * is a ForceModel type plus its parameters, see ball_forces.hpp */
 
 /* Useful functions for diagnostics */
 void print_vec(float v[6]);
 valarray<float> read_data(const string& filename, const size_t Ncol);
 
-/* Functions for numerical integration */
-double nintegrate1D(valarray<double> fi, double h, int NCpoints);
-double nintegrate1D(double a, double b, double (*func) (double x) , size_t N, int NCpoints);
+/* Functions for numerical integration: nintegrate1D() overloads
+ * for tabulated samples and for callables, see quadrature.hpp */
 
 /* You will need to implement the following functions */
 
@@ -50,7 +60,21 @@ void coord_xfm(valarray<float> &x_out, valarray<float> &y_out,
 
 /* q4.cpp */
 
+/* Ball state (x, y, z, vx, vy, vz). The array forms of rhs() and rk4()
+ * do no heap allocation; the valarray forms are wrappers around them.
+ * The array forms are templates on the scalar type, instantiated for
+ * float (BallState) and double. */
+template<class T>
+using BallStateOf = array<T, 6>;
+
+typedef BallStateOf<float> BallState;
+
+template<class T>
+void rhs(T t, const BallStateOf<T>& Y, BallStateOf<T>& dY);
 valarray<float> rhs(float t, valarray<float> yvec);
+
+template<class T>
+BallStateOf<T> rk4(T t0, BallStateOf<T> y0, T h, int N=1);
 valarray<float> rk4(float t0, valarray<float> y0, float h, int N=1);
 
 #endif // Q234_H_
@@ -0,0 +1,56 @@
+#include <iostream>
+#include <string>
+#include <cstdlib>
+#include "batch.hpp"
+
+using namespace std;
+
+/* Batch reprocessing of a directory or manifest of tracking files:
+ *
+ *   batch_runner <dir|manifest> [outdir] [-j threads] [--mem MiB]
+ *
+ * Writes <outdir>/<name>_speed.dat per match and
+ * <outdir>/batch_summary.dat with the per-match metrics and totals. */
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        cerr << "Usage: " << argv[0] << " <dir|manifest> [outdir] [-j threads] [--mem MiB]" << endl;
+        return 1;
+    }
+
+    string source = argv[1];
+    string outdir = "batch_out";
+    size_t nthreads = 0;       // 0 = one worker per hardware thread
+    size_t mem_mib = 512;      // memory budget for jobs in flight
+
+    for (int i = 2; i < argc; ++i) {
+        string arg = argv[i];
+        if (arg == "-j" && i + 1 < argc) {
+            nthreads = strtoul(argv[++i], nullptr, 10);
+        } else if (arg == "--mem" && i + 1 < argc) {
+            mem_mib = strtoul(argv[++i], nullptr, 10);
+        } else {
+            outdir = arg;
+        }
+    }
+
+    vector<string> inputs = collect_match_files(source);
+    if (inputs.empty()) {
+        cerr << "Error: no match files found in " << source << endl;
+        return 1;
+    }
+
+    vector<MatchSummary> results = run_batch(inputs, outdir, nthreads, mem_mib << 20);
+    write_batch_summary(outdir + "/batch_summary.dat", results);
+
+    size_t failed = 0;
+    for (const MatchSummary& r : results) {
+        if (!r.ok) {
+            cerr << "FAILED " << r.input << ": " << r.error << endl;
+            failed++;
+        }
+    }
+    cout << "Processed " << results.size() - failed << "/" << results.size()
+         << " matches, summary in " << outdir << "/batch_summary.dat" << endl;
+
+    return failed ? 2 : 0;
+}
@@ -0,0 +1,184 @@
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <cmath>
+#include "q234.hpp"
+#include "tracking.hpp"
+#include "reduce.hpp"
+#include "kalman.hpp"
+#include "energy_kernel.hpp"
+#include "thread_pool.hpp"
+#include "batch.hpp"
+
+using namespace std;
+namespace fs = std::filesystem;
+
+vector<string> collect_match_files(const string& path) {
+    vector<string> files;
+
+    if (fs::is_directory(path)) {
+        for (const fs::directory_entry& entry : fs::directory_iterator(path)) {
+            if (entry.is_regular_file() && entry.path().extension() == ".dat") {
+                files.push_back(entry.path().string());
+            }
+        }
+        sort(files.begin(), files.end());
+        return files;
+    }
+
+    ifstream manifest(path);
+    if (!manifest.is_open()) {
+        cerr << "Error: Unable to open directory or manifest " << path << endl;
+        return files;
+    }
+
+    fs::path base = fs::path(path).parent_path();
+    string line;
+    while (getline(manifest, line)) {
+        line = line.substr(0, line.find('#'));
+        size_t first = line.find_first_not_of(" \t\r");
+        if (first == string::npos) continue;
+        size_t last = line.find_last_not_of(" \t\r");
+        fs::path entry = line.substr(first, last - first + 1);
+        files.push_back(entry.is_absolute() ? entry.string() : (base / entry).string());
+    }
+
+    return files;
+}
+
+/* Rough upper bound of the memory a job needs for a file: the text
+ * is parsed into a float vector and copied into a handful of
+ * column-sized valarrays */
+static size_t estimate_job_bytes(const string& input) {
+    error_code ec;
+    uintmax_t size = fs::file_size(input, ec);
+    if (ec) return 0;
+    return 2 * size_t(size) + (64 << 10);
+}
+
+MatchSummary process_match_file(const string& input, const string& outdir) {
+    MatchSummary res;
+    res.input = input;
+
+    valarray<float> data = read_tracking_data(input);
+    size_t Ndata = data.size()/3;
+    if (Ndata < 3) {
+        res.error = "fewer than 3 frames";
+        return res;
+    }
+
+    valarray<float> t_varr(data[slice(0, Ndata, 3)]);
+    valarray<float> x_varr(data[slice(1, Ndata, 3)]);
+    valarray<float> y_varr(data[slice(2, Ndata, 3)]);
+
+    /* Normalised -> physical pitch coordinates, as in Q2(a) */
+    valarray<float> x_phys = x_varr * float(PITCH_L) - float(PITCH_L / 2.0);
+    valarray<float> y_phys = y_varr * float(PITCH_W) - float(PITCH_W / 2.0);
+
+    /* Constant-acceleration Kalman/RTS smoother instead of
+     * differencing the raw (noisy) positions */
+    KinematicTrack kin = kalman_smooth<3>(t_varr, x_phys, y_phys, KALMAN_Q_PLAYER, KALMAN_R_TRACKING);
+    size_t Nkin = kin.t.size();
+    if (Nkin < 3) {
+        res.error = "fewer than 3 frames with increasing timestamps";
+        return res;
+    }
+    valarray<float> t_c = kin.t;
+    valarray<float> v_c = sqrt(kin.vx * kin.vx + kin.vy * kin.vy);
+
+    const float* px = &kin.x[0];
+    const float* py = &kin.y[0];
+    double distance = reduce_indexed(Nkin - 1, [px, py](size_t i) {
+        double dx = double(px[i + 1]) - double(px[i]);
+        double dy = double(py[i + 1]) - double(py[i]);
+        return sqrt(dx * dx + dy * dy);
+    });
+
+    /* Power-speed curve of Q3(a) integrated over the (possibly
+     * non-uniform) timestamps in one fused pass */
+    double energy = integrate_power(t_c, v_c, player_power_curve());
+
+    string stem = fs::path(input).stem().string();
+    ofstream outfile(fs::path(outdir) / (stem + "_speed.dat"));
+    if (!outfile) {
+        res.error = "cannot write speed output";
+        return res;
+    }
+    outfile << fixed << setprecision(6);
+    for (size_t i = 0; i < v_c.size(); ++i) {
+        outfile << t_c[i] << " " << v_c[i] << "\n";
+    }
+
+    res.ok = true;
+    res.frames = Ndata;
+    res.duration = t_varr[Ndata - 1] - t_varr[0];
+    res.distance = float(distance);
+    res.max_speed = v_c.max();
+    res.mean_speed = float(reduce_sum<float>(v_c) / double(v_c.size()));
+    res.energy = float(energy);
+    return res;
+}
+
+vector<MatchSummary> run_batch(const vector<string>& inputs, const string& outdir,
+                               size_t nthreads, size_t max_inflight_bytes) {
+    vector<MatchSummary> results(inputs.size());
+    ThreadPool pool(nthreads);
+    MemoryBudget budget(max_inflight_bytes);
+
+    error_code ec;
+    fs::create_directories(outdir, ec);
+
+    /* The dispatcher reserves memory before a job is queued, so at
+     * most max_inflight_bytes worth of matches are loaded at once
+     * and the workers themselves never block on the budget */
+    for (size_t i = 0; i < inputs.size(); ++i) {
+        size_t bytes = estimate_job_bytes(inputs[i]);
+        budget.acquire(bytes);
+        pool.submit([&, i, bytes] {
+            try {
+                results[i] = process_match_file(inputs[i], outdir);
+            } catch (const exception& e) {
+                results[i].input = inputs[i];
+                results[i].error = e.what();
+            }
+            budget.release(bytes);
+        });
+    }
+    pool.wait_idle();
+
+    return results;
+}
+
+void write_batch_summary(const string& filename, const vector<MatchSummary>& results) {
+    ofstream out(filename);
+    if (!out) {
+        cerr << "Error: could not open summary file " << filename << endl;
+        return;
+    }
+
+    out << "# file frames duration[s] distance[m] max_speed[m/s] mean_speed[m/s] energy[J]\n";
+    out << fixed << setprecision(3);
+
+    size_t n_ok = 0, frames = 0;
+    float duration = 0.0f, distance = 0.0f, energy = 0.0f, vmax = 0.0f;
+    for (const MatchSummary& r : results) {
+        if (!r.ok) {
+            out << "# FAILED " << r.input << ": " << r.error << "\n";
+            continue;
+        }
+        out << r.input << " " << r.frames << " " << r.duration << " " << r.distance << " "
+            << r.max_speed << " " << r.mean_speed << " " << r.energy << "\n";
+        n_ok++;
+        frames += r.frames;
+        duration += r.duration;
+        distance += r.distance;
+        energy += r.energy;
+        vmax = max(vmax, r.max_speed);
+    }
+
+    out << "# TOTAL files=" << n_ok << "/" << results.size() << " frames=" << frames
+        << " duration=" << duration << " distance=" << distance
+        << " max_speed=" << vmax << " energy=" << energy << "\n";
+}
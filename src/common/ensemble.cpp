@@ -0,0 +1,278 @@
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+#include <tuple>
+#include "q234.hpp"
+#include "ball_forces.hpp"
+#include "ode_events.hpp"
+#include "ensemble.hpp"
+
+using namespace std;
+
+namespace {
+
+/* One batch in structure-of-arrays layout: s[c][l] is state component
+ * c (x, y, z, vx, vy, vz) of lane l */
+template<class T>
+struct LaneState {
+    static constexpr size_t W = ensemble_lanes<T>;
+    alignas(64) T s[6][W];
+};
+
+/* Per-lane parameters of a force term of ball_forces.hpp, in SoA
+ * layout; at(l) is the scalar term of lane l. Unused lanes repeat the
+ * last shot. */
+template<class T, class Term>
+struct LaneTerm;
+
+template<class T>
+struct LaneTerm<T, Gravity> {
+    void set(const ShotLaunch*, size_t) {}
+    Gravity at(size_t) const { return Gravity(); }
+};
+
+template<class T>
+struct LaneTerm<T, Drag<DragParamsOf<T> > > {
+    alignas(64) T c_drag[ensemble_lanes<T>];
+
+    void set(const ShotLaunch* shots, size_t n) {
+        for (size_t l = 0; l < ensemble_lanes<T>; ++l) c_drag[l] = T(C_DRAG * double(shots[min(l, n - 1)].drag_scale));
+    }
+    Drag<DragParamsOf<T> > at(size_t l) const {
+        Drag<DragParamsOf<T> > term;
+        term.params.c_drag = c_drag[l];
+        return term;
+    }
+};
+
+template<class T>
+struct LaneTerm<T, Magnus<SpinZOf<T> > > {
+    alignas(64) T wz[ensemble_lanes<T>];
+
+    void set(const ShotLaunch* shots, size_t n) {
+        for (size_t l = 0; l < ensemble_lanes<T>; ++l) wz[l] = T(shots[min(l, n - 1)].spin_z);
+    }
+    Magnus<SpinZOf<T> > at(size_t l) const {
+        Magnus<SpinZOf<T> > term;
+        term.spin.wz = wz[l];
+        return term;
+    }
+};
+
+/* ForceModel<Terms...> with one set of parameters per lane. The
+ * scalar model of a lane is rebuilt inside the lane loop from the
+ * SoA arrays; it inlines to the same straight-line force law as
+ * ForceModel::operator(), so the loop vectorises across lanes. */
+template<class T, class... Terms>
+struct LaneForceModel {
+    tuple<LaneTerm<T, Terms>...> terms;
+
+    void set(const ShotLaunch* shots, size_t n) {
+        apply([&](LaneTerm<T, Terms>&... term) { (term.set(shots, n), ...); }, terms);
+    }
+    ForceModel<Terms...> at(size_t l) const {
+        return apply([l](const LaneTerm<T, Terms>&... term) { return ForceModel<Terms...>{tuple<Terms...>(term.at(l)...)}; },
+                     terms);
+    }
+};
+
+/* rhs of the force model for all lanes */
+template<class T, class... Terms>
+inline void rhs_lanes(const LaneState<T>& Y, const LaneForceModel<T, Terms...>& model, LaneState<T>& dY) {
+    for (size_t l = 0; l < LaneState<T>::W; ++l) {
+        T v[3] = {Y.s[3][l], Y.s[4][l], Y.s[5][l]};
+        T a[3];
+        model.at(l).acceleration(v, a);
+        dY.s[0][l] = v[0];
+        dY.s[1][l] = v[1];
+        dY.s[2][l] = v[2];
+        dY.s[3][l] = a[0];
+        dY.s[4][l] = a[1];
+        dY.s[5][l] = a[2];
+    }
+}
+
+template<class T>
+inline void axpy_lanes(const LaneState<T>& Y, T a, const LaneState<T>& K, LaneState<T>& out) {
+    for (size_t c = 0; c < 6; ++c)
+        for (size_t l = 0; l < LaneState<T>::W; ++l) out.s[c][l] = Y.s[c][l] + a * K.s[c][l];
+}
+
+template<class T>
+BallStateOf<T> lane(const LaneState<T>& Y, size_t l) {
+    BallStateOf<T> S;
+    for (size_t c = 0; c < 6; ++c) S[c] = Y.s[c][l];
+    return S;
+}
+
+/* Earliest goal-line (x rising through PITCH_L/2) or ground (z falling
+ * through R_BALL) crossing of lane l in the step [t0, t1], or false */
+template<class T>
+bool locate_crossing(T t0, const BallStateOf<T>& Y0, const BallStateOf<T>& F0, T t1, const BallStateOf<T>& Y1,
+                     const BallStateOf<T>& F1, ShotResult& res) {
+    const T x_goal = T(PITCH_L / 2), z_ground = T(R_BALL);
+    bool goal = Y0[0] < x_goal && Y1[0] >= x_goal;
+    bool ground = Y0[2] > z_ground && Y1[2] <= z_ground;
+    if (!goal && !ground) return false;
+
+    BallStateOf<T> S;
+    T tol = T(4) * numeric_limits<T>::epsilon() * max(fabs(t0), fabs(t1));
+    T tc = t1;
+    bool at_goal = false;
+    if (goal) {
+        auto g = [&](T s) {
+            hermite_interp(t0, Y0, F0, t1, Y1, F1, s, S);
+            return S[0] - x_goal;
+        };
+        tc = illinois_root(g, t0, Y0[0] - x_goal, t1, Y1[0] - x_goal, tol);
+        at_goal = true;
+    }
+    if (ground) {
+        auto g = [&](T s) {
+            hermite_interp(t0, Y0, F0, t1, Y1, F1, s, S);
+            return S[2] - z_ground;
+        };
+        T tg = illinois_root(g, t0, Y0[2] - z_ground, t1, Y1[2] - z_ground, tol);
+        if (!goal || tg < tc) {
+            tc = tg;
+            at_goal = false;
+        }
+    }
+
+    hermite_interp(t0, Y0, F0, t1, Y1, F1, tc, S);
+    res.t = float(tc);
+    res.x = float(S[0]);
+    res.y = float(S[1]);
+    res.z = float(S[2]);
+    res.vx = float(S[3]);
+    res.vy = float(S[4]);
+    res.vz = float(S[5]);
+    if (at_goal) res.outcome = (S[2] <= T(GOAL_H)) ? ShotOutcome::Good : ShotOutcome::Over;
+    else res.outcome = ShotOutcome::Weak;
+    return true;
+}
+
+/* Integrate shots[first, first + n), n <= W, in lockstep under the
+ * force model with the terms Terms */
+template<class T, class... Terms>
+void simulate_batch(const ShotLaunch* shots, size_t n, T dt, ShotResult* out) {
+    constexpr size_t W = ensemble_lanes<T>;
+    LaneForceModel<T, Terms...> model;
+    model.set(shots, n);
+
+    LaneState<T> Y;
+    bool active[W];
+    for (size_t l = 0; l < W; ++l) {
+        /* unused lanes repeat the last shot and are masked out */
+        const ShotLaunch& s = shots[min(l, n - 1)];
+        T speed = T(s.speed), elevation = T(s.elevation), azimuth = T(s.azimuth);
+        T ce = cos(elevation);
+        Y.s[0][l] = T(s.x);
+        Y.s[1][l] = T(s.y);
+        Y.s[2][l] = T(s.z);
+        Y.s[3][l] = speed * ce * cos(azimuth);
+        Y.s[4][l] = speed * ce * sin(azimuth);
+        Y.s[5][l] = speed * sin(elevation);
+        active[l] = l < n;
+    }
+
+    LaneState<T> K1, K2, K3, K4, Ytmp, Yn;
+    rhs_lanes(Y, model, K1);
+    size_t remaining = n;
+    T t = T(0);
+    for (int k = 1; remaining > 0 && t < T(T_FLIGHT_MAX); ++k) {
+        T h = dt, h2 = T(0.5) * dt;
+        axpy_lanes(Y, h2, K1, Ytmp);
+        rhs_lanes(Ytmp, model, K2);
+        axpy_lanes(Y, h2, K2, Ytmp);
+        rhs_lanes(Ytmp, model, K3);
+        axpy_lanes(Y, h, K3, Ytmp);
+        rhs_lanes(Ytmp, model, K4);
+        for (size_t c = 0; c < 6; ++c)
+            for (size_t l = 0; l < W; ++l)
+                Yn.s[c][l] = Y.s[c][l] + h / T(6) * (K1.s[c][l] + T(2) * K2.s[c][l] + T(2) * K3.s[c][l] + K4.s[c][l]);
+
+        /* the derivative at the step end is the next step's k1 */
+        LaneState<T> F1;
+        rhs_lanes(Yn, model, F1);
+        T t1 = T(k) * dt;
+
+        /* per-lane terminal events */
+        for (size_t l = 0; l < W; ++l) {
+            if (!active[l]) continue;
+            bool goal = Yn.s[0][l] >= T(PITCH_L / 2);
+            bool ground = Yn.s[2][l] <= T(R_BALL);
+            if (!goal && !ground) continue;
+            if (locate_crossing(t, lane(Y, l), lane(K1, l), t1, lane(Yn, l), lane(F1, l), out[l])) {
+                active[l] = false;
+                remaining--;
+            }
+        }
+
+        Y = Yn;
+        K1 = F1;
+        t = t1;
+    }
+}
+
+/* One kernel per physics configuration, chosen once per batch */
+template<class T>
+void simulate_batch(const ShotLaunch* shots, size_t n, T dt, const BallPhysics& physics, ShotResult* out) {
+    using LaneDrag = Drag<DragParamsOf<T> >;
+    using LaneMagnus = Magnus<SpinZOf<T> >;
+    if (physics.drag && physics.magnus) simulate_batch<T, Gravity, LaneDrag, LaneMagnus>(shots, n, dt, out);
+    else if (physics.drag) simulate_batch<T, Gravity, LaneDrag>(shots, n, dt, out);
+    else if (physics.magnus) simulate_batch<T, Gravity, LaneMagnus>(shots, n, dt, out);
+    else simulate_batch<T, Gravity>(shots, n, dt, out);
+}
+
+} // namespace
+
+template<class T>
+vector<ShotResult> simulate_shots(const vector<ShotLaunch>& shots, float dt, const BallPhysics& physics,
+                                  ThreadPool& pool) {
+    constexpr size_t W = ensemble_lanes<T>;
+    vector<ShotResult> results(shots.size());
+    size_t nbatches = (shots.size() + W - 1) / W;
+    parallel_for(pool, nbatches, 1, [&](size_t first, size_t last) {
+        for (size_t b = first; b < last; ++b) {
+            size_t begin = b * W;
+            simulate_batch<T>(&shots[begin], min(W, shots.size() - begin), T(dt), physics, &results[begin]);
+        }
+    });
+    return results;
+}
+
+template<class T>
+vector<ShotResult> simulate_shots(const vector<ShotLaunch>& shots, float dt, const BallPhysics& physics) {
+    constexpr size_t W = ensemble_lanes<T>;
+    vector<ShotResult> results(shots.size());
+    for (size_t begin = 0; begin < shots.size(); begin += W) {
+        simulate_batch<T>(&shots[begin], min(W, shots.size() - begin), T(dt), physics, &results[begin]);
+    }
+    return results;
+}
+
+template vector<ShotResult> simulate_shots<float>(const vector<ShotLaunch>&, float, const BallPhysics&, ThreadPool&);
+template vector<ShotResult> simulate_shots<double>(const vector<ShotLaunch>&, float, const BallPhysics&, ThreadPool&);
+template vector<ShotResult> simulate_shots<float>(const vector<ShotLaunch>&, float, const BallPhysics&);
+template vector<ShotResult> simulate_shots<double>(const vector<ShotLaunch>&, float, const BallPhysics&);
+
+vector<ShotResult> simulate_shots(const vector<ShotLaunch>& shots, float dt, const BallPhysics& physics,
+                                  ThreadPool& pool) {
+    return simulate_shots<float>(shots, dt, physics, pool);
+}
+
+vector<ShotResult> simulate_shots(const vector<ShotLaunch>& shots, float dt, const BallPhysics& physics) {
+    return simulate_shots<float>(shots, dt, physics);
+}
+
+const char* shot_outcome_name(ShotOutcome outcome) {
+    switch (outcome) {
+    case ShotOutcome::Good: return "GOOD";
+    case ShotOutcome::Over: return "OVER";
+    case ShotOutcome::Weak: return "WEAK";
+    default: return "UNRESOLVED";
+    }
+}
@@ -4,42 +4,54 @@ using namespace std;
 
 
 /* Given an array of coordinates xi for an
- * ordered uniform grid of size n and a
- * value x, locate the index i for which
+ * ordered grid of size n and a value x,
+ * locate the index i for which
  * x \in [xi[i], xi[i+1]). (We assume that
  * the grid is given in incremental order
- * i.e. xi[i+1] - xi[i] > 0) */
-int locate(valarray<float>& xi, float x, bool uniform) {
+ * i.e. xi[i+1] - xi[i] > 0). For a uniform
+ * grid the index follows from arithmetic,
+ * otherwise it is found by bisection in
+ * O(log n) steps. */
+template<class T>
+int locate(const valarray<T>& xi, T x, bool uniform) {
 
     size_t n = xi.size();
     int idx;
-    float a, b, dx;
+    T a, b, dx;
 
     /* assign edge values of interpolation interval */
     a = xi[0];
     b = xi[n-1];
 
+    /* Special treatment if x=b */
+    if (x == b)
+      return int(n - 1);
+
+    /* Check that x \in [a,b] */
+    if (x < a || x > b) {
+      cerr << "ERROR: Cannot locate index. Coordinate x=" << x
+           << " lies outside the interpolation interval";
+      cerr << "[" << xi[0] << ", " << xi[n - 1] << "]." << endl;
+      return -1;
+    }
+
     if (uniform) {
       /* Calculate step size */
-      dx = (b - a) / (n - 1);
-
-      /* Special treatment if x=b */
-      if (x == b)
-        return n - 1;
-
-      /* Check that x \in [a,b] */
-      if (x < a || x > b) {
-        cerr << "ERROR: Cannot locate index. Coordinate x=" << x
-             << " lies outside the interpolation interval";
-        cerr << "[" << xi[0] << ", " << xi[n - 1] << "]." << endl;
-        return -1;
-      }
+      dx = (b - a) / T(n - 1);
 
       /* Find index assuming uniform grid */
-      idx = floor((x - a) / dx);
+      idx = int(floor((x - a) / dx));
     } else {
-        cerr << "Non-uniform version of locate() not implemented yet" << endl;
-        return -1;
+      /* Bisection: keep xi[lo] <= x < xi[hi] */
+      size_t lo = 0, hi = n - 1;
+      while (hi - lo > 1) {
+        size_t mid = (lo + hi) / 2;
+        if (xi[mid] <= x)
+          lo = mid;
+        else
+          hi = mid;
+      }
+      idx = int(lo);
     }
 
     return idx;
@@ -50,15 +62,16 @@ int locate(valarray<float>& xi, float x, bool uniform) {
  * has roots at each grid point except for xi[k]
  * and that is normalised so that its value on
  * xi[k] is 1.0. */
-float Lagrange_Nk(int k, valarray<float>& xi, float x) {
+template<class T>
+T Lagrange_Nk(int k, valarray<T>& xi, T x) {
 
     size_t n = xi.size();
-    float prod = 1.0;
+    T prod = T(1);
 
     /* For loop that calculates the product
      * of Eq.(7) from the Lecture Notes */
     for (size_t i=0;i<n;i++) {
-        if (i==k) continue;
+        if (i==size_t(k)) continue;
         prod *= (x - xi[i])/(xi[k] - xi[i]);
     }
 
@@ -69,17 +82,17 @@ float Lagrange_Nk(int k, valarray<float>& xi, float x) {
  * yi of n values, calculate the Lagrange interpolant
  * that passes from all data points (xi[i],yi[i]) and
  * return its value at a given point x in [xi[0],xi[n-1]]. */
-float Lagrange_N(valarray<float>& xi, valarray<float>& yi, float x) {
+template<class T>
+T Lagrange_N(valarray<T>& xi, valarray<T>& yi, T x) {
 
     size_t n = xi.size();
     assert(yi.size() == n);
 
-    int k;
-    float sum = 0.0;
+    T sum = T(0);
 
     /* Perform the linear superposition of all L_Nk(x) */
-    for (k=0;k<n;k++) {
-        sum += yi[k] * Lagrange_Nk(k, xi, x);
+    for (size_t k=0;k<n;k++) {
+        sum += yi[k] * Lagrange_Nk(int(k), xi, x);
     }
 
     return sum;
@@ -92,26 +105,27 @@ float Lagrange_N(valarray<float>& xi, valarray<float>& yi, float x) {
 /* Compute the coefficients of the interpolating polynomial
  * for the data (x_i, y_i), using Newton's formula for
  * divided differences. */
-valarray<float> interp_coeffs(const valarray<float>& xi, const valarray<float>& yi) {
-    int n = xi.size();
-    vector<valarray<float> > divided_differences(n, valarray<float>(n, 0.0));
-    valarray<float> coeffs(n);
+template<class T>
+valarray<T> interp_coeffs(const valarray<T>& xi, const valarray<T>& yi) {
+    size_t n = xi.size();
+    vector<valarray<T> > divided_differences(n, valarray<T>(T(0), n));
+    valarray<T> coeffs(n);
 
     // Initialize the first column with yi values
-    for (int i = 0; i < n; i++) {
+    for (size_t i = 0; i < n; i++) {
         divided_differences[i][0] = yi[i];
     }
 
     // Compute divided differences table
-    for (int j = 1; j < n; j++) {
-        for (int i = 0; i < n - j; i++) {
+    for (size_t j = 1; j < n; j++) {
+        for (size_t i = 0; i < n - j; i++) {
             divided_differences[i][j] =
                 (divided_differences[i + 1][j - 1] - divided_differences[i][j - 1]) / (xi[i + j] - xi[i]);
         }
     }
 
     /* Extract coefficients from divided differences */
-    for (int i = 0; i < n; i++) {
+    for (size_t i = 0; i < n; i++) {
         coeffs[i] = divided_differences[0][i];
     }
 
@@ -120,17 +134,31 @@ valarray<float> interp_coeffs(const valarray<float>& xi, const valarray<float>&
 
 /* Function that evaluates the interpolating polynomial at a given x
  * given its coefficients that interp_coeffs() computed for the grid xi */
-float poly_eval(const vector<float>& coeffs, const vector<float>& xi, float x) {
-    int n = coeffs.size();
+template<class T>
+T poly_eval(const vector<T>& coeffs, const vector<T>& xi, T x) {
+    size_t n = coeffs.size();
 
     /* Evaluate interpolating polynomial using nested form.
      * Start with higher order coefficient (see e.g. Numerical
      * Recipes 3rd Ed. Sec.3.2) */
-    float result = coeffs[n - 1];
+    T result = coeffs[n - 1];
 
-    for (int i = n - 2; i >= 0; i--) {
+    for (size_t i = n - 1; i-- > 0;) {
         result = result * (x - xi[i]) + coeffs[i];
     }
 
     return result;
 }
+
+/* Explicit instantiations */
+#define INTERP_INSTANTIATE(T)                                                   \
+    template int locate(const valarray<T>&, T, bool);                           \
+    template T Lagrange_Nk(int, valarray<T>&, T);                               \
+    template T Lagrange_N(valarray<T>&, valarray<T>&, T);                       \
+    template valarray<T> interp_coeffs(const valarray<T>&, const valarray<T>&); \
+    template T poly_eval(const vector<T>&, const vector<T>&, T);
+
+INTERP_INSTANTIATE(float)
+INTERP_INSTANTIATE(double)
+INTERP_INSTANTIATE(long double)
+#undef INTERP_INSTANTIATE
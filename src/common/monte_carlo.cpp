@@ -0,0 +1,116 @@
+#include <algorithm>
+#include <cmath>
+#include "philox.hpp"
+#include "monte_carlo.hpp"
+
+using namespace std;
+
+namespace {
+
+/* Per-task tallies, merged in task order */
+struct Tally {
+    size_t count[4] = {0, 0, 0, 0};
+    double sum_y = 0.0, sum_z = 0.0, sum_yy = 0.0, sum_zz = 0.0;
+    vector<size_t> hist;
+    size_t outside = 0;
+};
+
+ShotLaunch perturb(const ShotLaunch& nominal, const ShotSpread& spread, const Philox4x32& rng, uint64_t i) {
+    uint32_t lo = uint32_t(i), hi = uint32_t(i >> 32);
+    array<double, 4> a = rng.normal({lo, hi, 0u, 0u});
+    array<double, 4> b = rng.normal({lo, hi, 1u, 0u});
+
+    ShotLaunch s = nominal;
+    s.speed += spread.speed * float(a[0]);
+    s.elevation += spread.elevation * float(a[1]);
+    s.azimuth += spread.azimuth * float(a[2]);
+    s.spin_z += spread.spin_z * float(a[3]);
+    s.drag_scale *= max(0.0f, 1.0f + spread.drag_scale * float(b[0]));
+    return s;
+}
+
+void run_task(const ShotLaunch& nominal, const ShotSpread& spread, const MonteCarloOptions& opt,
+              uint64_t first, const GoalPlaneHistogram& grid, Tally& tally) {
+    Philox4x32 rng(opt.seed);
+    vector<ShotLaunch> shots(opt.samples_per_task);
+    for (size_t k = 0; k < shots.size(); ++k) shots[k] = perturb(nominal, spread, rng, first + k);
+    vector<ShotResult> results = simulate_shots(shots, opt.dt, opt.physics);
+
+    tally.hist.assign(grid.ny * grid.nz, 0);
+    for (const ShotResult& r : results) {
+        tally.count[int(r.outcome)]++;
+        if (r.outcome != ShotOutcome::Good && r.outcome != ShotOutcome::Over) continue;
+        tally.sum_y += r.y;
+        tally.sum_z += r.z;
+        tally.sum_yy += double(r.y) * r.y;
+        tally.sum_zz += double(r.z) * r.z;
+        float fy = (r.y - grid.y_min) / (grid.y_max - grid.y_min) * float(grid.ny);
+        float fz = (r.z - grid.z_min) / (grid.z_max - grid.z_min) * float(grid.nz);
+        if (fy >= 0.0f && fy < float(grid.ny) && fz >= 0.0f && fz < float(grid.nz)) {
+            tally.hist[size_t(fz) * grid.ny + size_t(fy)]++;
+        } else {
+            tally.outside++;
+        }
+    }
+}
+
+} // namespace
+
+MonteCarloResult estimate_shot_outcomes(const ShotLaunch& nominal, const ShotSpread& spread,
+                                        const MonteCarloOptions& options, ThreadPool& pool) {
+    MonteCarloOptions opt = options;
+    opt.samples_per_task = max<size_t>(opt.samples_per_task, 1);
+    opt.tasks_per_round = max<size_t>(opt.tasks_per_round, 1);
+
+    MonteCarloResult res;
+    res.landing.counts.assign(res.landing.ny * res.landing.nz, 0);
+    double sum_y = 0.0, sum_z = 0.0, sum_yy = 0.0, sum_zz = 0.0;
+
+    vector<Tally> tallies(opt.tasks_per_round);
+    while (res.samples < opt.max_samples) {
+        uint64_t base = res.samples;
+        parallel_for(pool, tallies.size(), 1, [&](size_t first, size_t last) {
+            for (size_t k = first; k < last; ++k) {
+                tallies[k] = Tally();
+                run_task(nominal, spread, opt, base + k * opt.samples_per_task, res.landing, tallies[k]);
+            }
+        });
+
+        for (const Tally& t : tallies) {
+            for (int o = 0; o < 4; ++o) res.count[o] += t.count[o];
+            sum_y += t.sum_y;
+            sum_z += t.sum_z;
+            sum_yy += t.sum_yy;
+            sum_zz += t.sum_zz;
+            for (size_t b = 0; b < t.hist.size(); ++b) res.landing.counts[b] += t.hist[b];
+            res.landing.outside += t.outside;
+        }
+        res.samples += tallies.size() * opt.samples_per_task;
+
+        /* Wilson score interval of each proportion (stays meaningful
+         * for outcomes that have not been observed yet) */
+        double n = double(res.samples);
+        double z2 = opt.z * opt.z;
+        double widest = 0.0;
+        for (int o = 0; o < 4; ++o) {
+            double p = double(res.count[o]) / n;
+            res.probability[o] = p;
+            res.ci_halfwidth[o] = opt.z / (1.0 + z2 / n) * sqrt(p * (1.0 - p) / n + z2 / (4.0 * n * n));
+            widest = max(widest, res.ci_halfwidth[o]);
+        }
+        if (res.samples >= opt.min_samples && widest <= opt.ci_halfwidth) {
+            res.converged = true;
+            break;
+        }
+    }
+
+    size_t on_plane = res.count[int(ShotOutcome::Good)] + res.count[int(ShotOutcome::Over)];
+    if (on_plane > 0) {
+        double m = double(on_plane);
+        res.mean_y = sum_y / m;
+        res.mean_z = sum_z / m;
+        res.sd_y = sqrt(max(0.0, sum_yy / m - res.mean_y * res.mean_y));
+        res.sd_z = sqrt(max(0.0, sum_zz / m - res.mean_z * res.mean_z));
+    }
+    return res;
+}
@@ -0,0 +1,86 @@
+#include <algorithm>
+#include <cmath>
+#include "prefix_integral.hpp"
+
+using namespace std;
+
+PrefixIntegral::PrefixIntegral(float t_start, float step, PrefixRule local_rule)
+    : t0(t_start), h(step), rule(local_rule) {}
+
+PrefixIntegral::PrefixIntegral(array_view<const float> fi, float t_start, float step, PrefixRule local_rule)
+    : t0(t_start), h(step), rule(local_rule), f(fi.begin(), fi.end()) {
+    C.assign(f.size(), 0.0);
+    update_from(0);
+}
+
+void PrefixIntegral::append(float fi) {
+    f.push_back(fi);
+    C.push_back(0.0);
+    /* The cubic stencil of the last interval is one-sided; the two
+     * intervals before it switch to centred stencils as samples arrive */
+    size_t n = f.size();
+    update_from(n > 4 ? n - 4 : 0);
+}
+
+/* Recompute C[j+1..n-1] from C[j] */
+void PrefixIntegral::update_from(size_t j) {
+    for (size_t i = j; i + 1 < f.size(); ++i) {
+        C[i + 1] = C[i] + interval_integral(i, 1.0);
+    }
+}
+
+/* Integral from t_j to t_j + s*h (0 <= s <= 1) of the local
+ * interpolant of interval j */
+double PrefixIntegral::interval_integral(size_t j, double s) const {
+    size_t n = f.size();
+    if (rule == PrefixRule::Trapezoid || n < 4) {
+        double fs = (1.0 - s) * double(f[j]) + s * double(f[j + 1]);
+        return 0.5 * h * s * (double(f[j]) + fs);
+    }
+
+    /* Stencil of 4 samples at integer offsets from j: centred where
+     * possible, one-sided on the first and last interval */
+    long first = (j == 0) ? 0 : (j == n - 2) ? -2 : -1;
+
+    double sum = 0.0;
+    for (int k = 0; k < 4; ++k) {
+        /* Expand L_k(u) = prod_{m != k} (u - o_m) / (o_k - o_m) into
+         * monomial coefficients c[0..3] and integrate from 0 to s */
+        double c[4] = {1.0, 0.0, 0.0, 0.0};
+        double ok = double(first + k), denom = 1.0;
+        int deg = 0;
+        for (int m = 0; m < 4; ++m) {
+            if (m == k) continue;
+            double om = double(first + m);
+            for (int d = deg + 1; d > 0; --d) c[d] = c[d - 1] - om * c[d];
+            c[0] *= -om;
+            deg++;
+            denom *= ok - om;
+        }
+        double integ = 0.0, sp = s;
+        for (int d = 0; d < 4; ++d) {
+            integ += c[d] * sp / double(d + 1);
+            sp *= s;
+        }
+        sum += double(f[size_t(long(j) + first + k)]) * integ / denom;
+    }
+    return h * sum;
+}
+
+double PrefixIntegral::cumulative(double t) const {
+    size_t n = f.size();
+    if (n < 2) return 0.0;
+
+    /* locate()-style uniform arithmetic */
+    double x = (t - t0) / h;
+    if (x <= 0.0) return 0.0;
+    if (x >= double(n - 1)) return C[n - 1];
+    size_t j = min(size_t(floor(x)), n - 2);
+    return C[j] + interval_integral(j, x - double(j));
+}
+
+vector<double> PrefixIntegral::integral(array_view<const float> ta, array_view<const float> tb) const {
+    vector<double> out(min(ta.size(), tb.size()));
+    for (size_t k = 0; k < out.size(); ++k) out[k] = integral(ta[k], tb[k]);
+    return out;
+}
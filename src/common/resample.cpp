@@ -0,0 +1,138 @@
+#include <cmath>
+#include <limits>
+#include "interp.hpp"
+#include "resample.hpp"
+
+using namespace std;
+
+/* Read position of one input stream during the merge pass. The
+ * output clock only moves forward, so the bracketing interval
+ * [t[i], t[i+1]] only moves forward too and each input sample is
+ * passed over once: O(1) amortised work per output sample. */
+struct StreamCursor {
+    const TimeStream* s;
+    size_t n;
+    size_t i = 0;      // bracketing interval of the window centre
+    size_t lo = 0;     // bracketing interval of the window start
+    size_t hi = 0;     // bracketing interval of the window end
+    vector<double> C;  // running integral of the linear interpolant (Average mode)
+
+    explicit StreamCursor(const TimeStream& stream) : s(&stream), n(stream.t.size()) {
+        if (s->mode == ResampleMode::Average && n > 0) build_integral();
+    }
+
+    /* Cumulative trapezoid integral, C[j*nchan + c] = int_{t[0]}^{t[j]} */
+    void build_integral() {
+        size_t nc = s->nchan;
+        C.assign(n * nc, 0.0);
+        for (size_t j = 1; j < n; ++j) {
+            double h = double(s->t[j]) - double(s->t[j - 1]);
+            for (size_t c = 0; c < nc; ++c) {
+                C[j * nc + c] = C[(j - 1) * nc + c]
+                    + 0.5 * h * (double(s->v[(j - 1) * nc + c]) + double(s->v[j * nc + c]));
+            }
+        }
+    }
+
+    /* Start all cursors at the first output time with one non-uniform
+     * locate() instead of walking from the first sample */
+    void seek(float tau) {
+        if (n < 2 || tau <= s->t[0]) return;
+        if (tau >= s->t[n - 1]) {
+            i = lo = hi = n - 2;
+            return;
+        }
+        int k = locate(s->t, tau, false);
+        i = lo = hi = size_t(k < 0 ? 0 : k);
+    }
+
+    /* Move interval index j forward until t[j+1] > tau (or last interval) */
+    void advance(size_t& j, float tau) const {
+        while (j + 2 < n && s->t[j + 1] <= tau) j++;
+    }
+
+    bool covers(float tau) const {
+        return n > 0 && tau >= s->t[0] && tau <= s->t[n - 1];
+    }
+
+    float lerp(size_t j, size_t c, float tau) const {
+        size_t nc = s->nchan;
+        float t0 = s->t[j], t1 = s->t[j + 1];
+        float w = (tau - t0) / (t1 - t0);
+        return (1.0f - w) * s->v[j * nc + c] + w * s->v[(j + 1) * nc + c];
+    }
+
+    /* int_{t[0]}^{tau} of the linear interpolant, tau in interval j */
+    double integral_to(size_t j, size_t c, float tau) const {
+        float f_tau = lerp(j, c, tau);
+        return C[j * s->nchan + c]
+            + 0.5 * (double(tau) - double(s->t[j])) * (double(s->v[j * s->nchan + c]) + double(f_tau));
+    }
+
+    void sample(float tau, float dt, float* out) {
+        size_t nc = s->nchan;
+        if (!covers(tau)) {
+            for (size_t c = 0; c < nc; ++c) out[c] = numeric_limits<float>::quiet_NaN();
+            return;
+        }
+        if (n == 1) {
+            for (size_t c = 0; c < nc; ++c) out[c] = s->v[c];
+            return;
+        }
+
+        advance(i, tau);
+        switch (s->mode) {
+        case ResampleMode::Linear:
+            for (size_t c = 0; c < nc; ++c) out[c] = lerp(i, c, tau);
+            break;
+        case ResampleMode::Nearest: {
+            size_t k = (tau - s->t[i] <= s->t[i + 1] - tau) ? i : i + 1;
+            for (size_t c = 0; c < nc; ++c) out[c] = s->v[k * nc + c];
+            break;
+        }
+        case ResampleMode::Average: {
+            /* Window clipped to the stream's time span */
+            float a = max(tau - 0.5f * dt, s->t[0]);
+            float b = min(tau + 0.5f * dt, s->t[n - 1]);
+            advance(lo, a);
+            advance(hi, b);
+            for (size_t c = 0; c < nc; ++c) {
+                out[c] = (b > a) ? float((integral_to(hi, c, b) - integral_to(lo, c, a)) / (double(b) - double(a)))
+                                 : lerp(i, c, tau);
+            }
+            break;
+        }
+        }
+    }
+};
+
+/* Single merge pass over all streams: for every output frame, each
+ * cursor advances past the samples that the frame has overtaken and
+ * evaluates its stream there. */
+FrameStream align_streams(const vector<TimeStream>& streams, float t0, float dt, size_t nframes) {
+    FrameStream out;
+    for (const TimeStream& s : streams) out.nchan += s.nchan;
+    out.t.resize(nframes);
+    out.v.resize(nframes * out.nchan);
+    if (out.nchan == 0) return out;
+
+    vector<StreamCursor> cursors;
+    cursors.reserve(streams.size());
+    for (const TimeStream& s : streams) {
+        cursors.emplace_back(s);
+        cursors.back().seek(t0 - 0.5f * dt);
+    }
+
+    for (size_t k = 0; k < nframes; ++k) {
+        float tau = t0 + float(k) * dt;
+        out.t[k] = tau;
+
+        float* frame = &out.v[k * out.nchan];
+        for (StreamCursor& cur : cursors) {
+            cur.sample(tau, dt, frame);
+            frame += cur.s->nchan;
+        }
+    }
+
+    return out;
+}
@@ -0,0 +1,135 @@
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+#include "q234.hpp"
+#include "dual.hpp"
+#include "ball_forces.hpp"
+#include "ode_events.hpp"
+#include "shot_sensitivity.hpp"
+
+using namespace std;
+
+namespace {
+
+typedef array<double, 6> PlainState;
+
+template<class State>
+PlainState values(const State& Y) {
+    PlainState S;
+    for (size_t c = 0; c < 6; ++c) S[c] = Y[c].v;
+    return S;
+}
+
+/* Integrate with N derivative slots; slot k belongs to parameter slot_param[k] */
+template<int N>
+ShotSensitivity sensitivity_n(const ShotLaunch& s, const int* slot_param, float dt, const BallPhysics& physics) {
+    typedef Dual<N> D;
+    typedef array<D, 6> State;
+
+    D p[SHOT_NPARAM] = {D(s.speed), D(s.elevation), D(s.azimuth), D(s.spin_z), D(s.drag_scale)};
+    for (int k = 0; k < N; ++k) p[slot_param[k]].d[k] = 1.0;
+
+    DragParamsOf<D> drag;
+    drag.c_drag = physics.drag ? D(C_DRAG) * p[4] : D(0);
+    SpinZOf<D> spin{physics.magnus ? p[3] : D(0)};
+    auto forces = make_force_model(Gravity(), Drag<DragParamsOf<D> >{drag}, Magnus<SpinZOf<D> >{spin});
+
+    D ce = cos(p[1]);
+    State Y = {D(s.x), D(s.y), D(s.z), p[0] * ce * cos(p[2]), p[0] * ce * sin(p[2]), p[0] * sin(p[1])};
+    State F0, F1;
+    forces(D(0), Y, F0);
+
+    const double x_goal = PITCH_L / 2, z_ground = R_BALL;
+    const double h = double(dt);
+    ShotSensitivity out;
+    double t = 0.0;
+    for (int n = 1; t < double(T_FLIGHT_MAX); ++n) {
+        double t0 = t;
+        State Y0 = Y;
+        rk4_step(forces, D(t0), Y, D(h));
+        t = double(n) * h;
+        forces(D(t), Y, F1);
+
+        bool goal = Y0[0].v < x_goal && Y[0].v >= x_goal;
+        bool ground = Y0[2].v > z_ground && Y[2].v <= z_ground;
+        if (!goal && !ground) {
+            F0 = F1;
+            continue;
+        }
+
+        /* crossing time on the value part of the interpolant */
+        PlainState y0 = values(Y0), f0 = values(F0), y1 = values(Y), f1 = values(F1), S;
+        double tol = 4.0 * numeric_limits<double>::epsilon() * t;
+        double tc = t;
+        int comp = 0;
+        if (goal) {
+            auto g = [&](double q) {
+                hermite_interp(t0, y0, f0, t, y1, f1, q, S);
+                return S[0] - x_goal;
+            };
+            tc = illinois_root(g, t0, y0[0] - x_goal, t, y1[0] - x_goal, tol);
+        }
+        if (ground) {
+            auto g = [&](double q) {
+                hermite_interp(t0, y0, f0, t, y1, f1, q, S);
+                return S[2] - z_ground;
+            };
+            double tg = illinois_root(g, t0, y0[2] - z_ground, t, y1[2] - z_ground, tol);
+            if (!goal || tg < tc) {
+                tc = tg;
+                comp = 2;
+            }
+        }
+
+        /* dual state at the fixed time tc, then the implicit derivative
+         * of the crossing time: g(tc(p), p) = 0 */
+        State Yc;
+        hermite_interp(D(t0), Y0, F0, D(t), Y, F1, D(tc), Yc);
+        double gdot = Yc[size_t(comp) + 3].v;
+        for (int k = 0; k < N; ++k) {
+            int j = slot_param[k];
+            double dtc = (gdot != 0.0) ? -Yc[size_t(comp)].d[k] / gdot : 0.0;
+            out.dt[j] = dtc;
+            out.dx[j] = Yc[0].d[k] + Yc[3].v * dtc;
+            out.dy[j] = Yc[1].d[k] + Yc[4].v * dtc;
+            out.dz[j] = Yc[2].d[k] + Yc[5].v * dtc;
+        }
+
+        ShotResult& r = out.hit;
+        r.t = float(tc);
+        r.x = float(Yc[0].v);
+        r.y = float(Yc[1].v);
+        r.z = float(Yc[2].v);
+        r.vx = float(Yc[3].v);
+        r.vy = float(Yc[4].v);
+        r.vz = float(Yc[5].v);
+        if (comp == 0) r.outcome = (Yc[2].v <= GOAL_H) ? ShotOutcome::Good : ShotOutcome::Over;
+        else r.outcome = ShotOutcome::Weak;
+        return out;
+    }
+    return out;
+}
+
+} // namespace
+
+ShotSensitivity shot_sensitivity(const ShotLaunch& launch, unsigned params, float dt, const BallPhysics& physics) {
+    int slot_param[SHOT_NPARAM], n = 0;
+    for (int j = 0; j < SHOT_NPARAM; ++j)
+        if (params & (1u << j)) slot_param[n++] = j;
+
+    switch (n) {
+    case 0: {
+        /* crossing only: run one slot and drop its derivatives */
+        slot_param[0] = 0;
+        ShotSensitivity out = sensitivity_n<1>(launch, slot_param, dt, physics);
+        out.dt[0] = out.dx[0] = out.dy[0] = out.dz[0] = 0.0;
+        return out;
+    }
+    case 1: return sensitivity_n<1>(launch, slot_param, dt, physics);
+    case 2: return sensitivity_n<2>(launch, slot_param, dt, physics);
+    case 3: return sensitivity_n<3>(launch, slot_param, dt, physics);
+    case 4: return sensitivity_n<4>(launch, slot_param, dt, physics);
+    default: return sensitivity_n<5>(launch, slot_param, dt, physics);
+    }
+}
@@ -0,0 +1,142 @@
+#include <algorithm>
+#include <cmath>
+#include "q234.hpp"
+#include "shot_solver.hpp"
+
+using namespace std;
+
+namespace {
+
+const int NPARAM = SHOT_NPARAM;
+
+/* Bounds that keep the iterates physical */
+const float PARAM_MIN[NPARAM] = {1.0f, -0.2f, -1.5f, -100.0f, 0.0f};
+const float PARAM_MAX[NPARAM] = {60.0f, 1.4f, 1.5f, 100.0f, 3.0f};
+
+float& parameter(ShotLaunch& s, int j) {
+    switch (j) {
+    case 0: return s.speed;
+    case 1: return s.elevation;
+    case 2: return s.azimuth;
+    case 3: return s.spin_z;
+    default: return s.drag_scale;
+    }
+}
+
+/* Residual of one simulated shot, continued past the ground for
+ * shots that land short of the goal line */
+void residual(const ShotResult& r, const ShotTarget& target, double res[2]) {
+    double z = r.z;
+    if (r.outcome == ShotOutcome::Weak) z -= PITCH_L / 2 - r.x;
+    else if (r.outcome == ShotOutcome::Unresolved) z = -1e3;
+    res[0] = double(r.y) - target.y;
+    res[1] = z - target.z;
+}
+
+/* Solve the k x k system A x = b (Gaussian elimination, partial pivoting) */
+bool solve_small(double A[NPARAM][NPARAM], double b[NPARAM], int k) {
+    for (int c = 0; c < k; ++c) {
+        int piv = c;
+        for (int r = c + 1; r < k; ++r)
+            if (fabs(A[r][c]) > fabs(A[piv][c])) piv = r;
+        if (A[piv][c] == 0.0) return false;
+        swap(A[c], A[piv]);
+        swap(b[c], b[piv]);
+        for (int r = c + 1; r < k; ++r) {
+            double m = A[r][c] / A[c][c];
+            for (int j = c; j < k; ++j) A[r][j] -= m * A[c][j];
+            b[r] -= m * b[c];
+        }
+    }
+    for (int c = k - 1; c >= 0; --c) {
+        for (int j = c + 1; j < k; ++j) b[c] -= A[c][j] * b[j];
+        b[c] /= A[c][c];
+    }
+    return true;
+}
+
+} // namespace
+
+InverseShotResult solve_shot(const ShotLaunch& guess, const ShotTarget& target, const InverseShotOptions& options) {
+    int free[NPARAM], k = 0;
+    for (int j = 0; j < NPARAM; ++j)
+        if (options.free_params & (1u << j)) free[k++] = j;
+
+    InverseShotResult out;
+    out.launch = guess;
+    double r[2], J[2][NPARAM];
+    double lambda = 1e-3;
+
+    /* crossing and Jacobian from one dual-number integration; the
+     * continued residual of a short shot, z - (PITCH_L/2 - x), has
+     * the derivative dz + dx */
+    auto linearise = [&](const ShotSensitivity& sens) {
+        out.hit = sens.hit;
+        residual(sens.hit, target, r);
+        bool weak = sens.hit.outcome == ShotOutcome::Weak;
+        for (int i = 0; i < k; ++i) {
+            int j = free[i];
+            J[0][i] = sens.dy[j];
+            J[1][i] = weak ? sens.dz[j] + sens.dx[j] : sens.dz[j];
+        }
+        out.residual = hypot(r[0], r[1]);
+    };
+
+    linearise(shot_sensitivity(out.launch, options.free_params, options.dt, options.physics));
+    for (out.iterations = 0; out.iterations < options.max_iterations; ++out.iterations) {
+        if (out.residual <= options.tolerance) break;
+        if (k == 0) break;
+
+        double JtJ[NPARAM][NPARAM], Jtr[NPARAM];
+        for (int a = 0; a < k; ++a) {
+            Jtr[a] = J[0][a] * r[0] + J[1][a] * r[1];
+            for (int b = 0; b < k; ++b) JtJ[a][b] = J[0][a] * J[0][b] + J[1][a] * J[1][b];
+        }
+
+        /* increase the damping until a step reduces the residual */
+        bool improved = false;
+        while (!improved && lambda < 1e8) {
+            double A[NPARAM][NPARAM], dp[NPARAM];
+            for (int a = 0; a < k; ++a) {
+                for (int b = 0; b < k; ++b) A[a][b] = JtJ[a][b];
+                A[a][a] += lambda * max(JtJ[a][a], 1e-9);
+                dp[a] = -Jtr[a];
+            }
+            if (!solve_small(A, dp, k)) {
+                lambda *= 10.0;
+                continue;
+            }
+
+            ShotLaunch trial = out.launch;
+            for (int i = 0; i < k; ++i) {
+                int j = free[i];
+                parameter(trial, j) = min(PARAM_MAX[j], max(PARAM_MIN[j], parameter(trial, j) + float(dp[i])));
+            }
+            double rt[2];
+            ShotSensitivity sens = shot_sensitivity(trial, options.free_params, options.dt, options.physics);
+            residual(sens.hit, target, rt);
+            if (hypot(rt[0], rt[1]) < out.residual) {
+                out.launch = trial;
+                linearise(sens);
+                lambda = max(lambda / 10.0, 1e-9);
+                improved = true;
+            } else {
+                lambda *= 10.0;
+            }
+        }
+        if (!improved) break;
+    }
+
+    out.converged = out.residual <= options.tolerance &&
+                    (out.hit.outcome == ShotOutcome::Good || out.hit.outcome == ShotOutcome::Over);
+    return out;
+}
+
+vector<InverseShotResult> solve_shots(const ShotLaunch& guess, const vector<ShotTarget>& targets,
+                                      const InverseShotOptions& options, ThreadPool& pool) {
+    vector<InverseShotResult> results(targets.size());
+    parallel_for(pool, targets.size(), 1, [&](size_t first, size_t last) {
+        for (size_t i = first; i < last; ++i) results[i] = solve_shot(guess, targets[i], options);
+    });
+    return results;
+}
@@ -0,0 +1,276 @@
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <type_traits>
+#include "q234.hpp"
+#include "philox.hpp"
+#include "shot_surrogate.hpp"
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define SURROGATE_MMAP 1
+#endif
+
+using namespace std;
+
+static_assert(is_trivially_copyable<SurrogateHeader>::value && is_trivially_copyable<SurrogateNode>::value,
+              "surrogate tables are written and mapped as raw memory");
+
+static const char SURROGATE_MAGIC[8] = {'S', 'H', 'O', 'T', 'S', 'R', 'G', '1'};
+static const uint32_t SURROGATE_VERSION = 1;
+static const uint64_t SURROGATE_ALIGN = 64;
+static const float SURROGATE_SAFETY = 4.0f;
+
+namespace {
+
+const float DEG = float(M_PI / 180.0);
+
+/* Goal-line crossing of a simulated shot as (t, y, continued z) */
+void crossing(const ShotResult& r, float& t, float& y, float& z) {
+    if (r.outcome == ShotOutcome::Unresolved) {
+        t = y = z = numeric_limits<float>::quiet_NaN();
+        return;
+    }
+    t = r.t;
+    y = r.y;
+    z = r.z;
+    if (r.outcome == ShotOutcome::Weak) z -= float(PITCH_L / 2) - r.x;
+}
+
+/* |f0 - 2 f1 + f2|, zero next to unresolved nodes */
+float second_difference(float f0, float f1, float f2) {
+    float d = fabs(f0 - 2.0f * f1 + f2);
+    return (d == d) ? d : 0.0f;
+}
+
+ShotLaunch launch_at(const ShotLaunch& origin, const float p[4]) {
+    ShotLaunch s = origin;
+    s.speed = p[0];
+    s.elevation = p[1];
+    s.azimuth = p[2];
+    s.spin_z = p[3];
+    return s;
+}
+
+}
+
+SurrogateGrid default_surrogate_grid() {
+    SurrogateGrid g;
+    g.axis[0] = SurrogateAxis{10.0f, 40.0f, 31};
+    g.axis[1] = SurrogateAxis{2.0f * DEG, 45.0f * DEG, 44};
+    g.axis[2] = SurrogateAxis{-30.0f * DEG, 30.0f * DEG, 31};
+    g.axis[3] = SurrogateAxis{-20.0f, 20.0f, 17};
+    return g;
+}
+
+void ShotSurrogate::build(const SurrogateGrid& grid, const ShotLaunch& origin, float dt, const BallPhysics& physics,
+                          ThreadPool& pool, size_t validation_samples) {
+    close();
+    head = SurrogateHeader{};
+    memcpy(head.magic, SURROGATE_MAGIC, sizeof(head.magic));
+    head.version = SURROGATE_VERSION;
+    head.physics = (physics.drag ? 1u : 0u) | (physics.magnus ? 2u : 0u);
+    head.grid = grid;
+    for (SurrogateAxis& a : head.grid.axis) a.n = max<uint32_t>(a.n, 2);
+    head.origin = origin;
+    head.dt = dt;
+    head.z_ground = float(R_BALL);
+    head.z_bar = float(GOAL_H);
+    head.nodes = 1;
+    for (const SurrogateAxis& a : head.grid.axis) head.nodes *= a.n;
+    head.data_offset = (sizeof(SurrogateHeader) + SURROGATE_ALIGN - 1) / SURROGATE_ALIGN * SURROGATE_ALIGN;
+    index();
+
+    /* Every node is one shot of the ensemble integrator */
+    size_t n = size_t(head.nodes);
+    vector<ShotLaunch> shots(n);
+    parallel_for(pool, n, 4096, [&](size_t first, size_t last) {
+        for (size_t k = first; k < last; ++k) {
+            float p[4];
+            size_t r = k;
+            for (int d = 3; d >= 0; --d) {
+                const SurrogateAxis& a = head.grid.axis[d];
+                p[d] = a.lo + float(r % a.n) * a.step();
+                r /= a.n;
+            }
+            shots[k] = launch_at(origin, p);
+        }
+    });
+    vector<ShotResult> results = simulate_shots(shots, dt, physics, pool);
+    shots = vector<ShotLaunch>();
+
+    owned.resize(n);
+    for (size_t k = 0; k < n; ++k) {
+        SurrogateNode& s = owned[k];
+        crossing(results[k], s.t, s.y, s.z);
+        s.err_t = s.err_y = s.err_z = 0.0f;
+    }
+    results = vector<ShotResult>();
+    node = owned.data();
+
+    /* Per-node curvature sum_d |second difference along d|, one-sided
+     * (shifted inwards) at the edges of the grid */
+    vector<SurrogateNode> curv(n);
+    parallel_for(pool, n, 4096, [&](size_t first, size_t last) {
+        for (size_t k = first; k < last; ++k) {
+            float ct = 0.0f, cy = 0.0f, cz = 0.0f;
+            for (int d = 0; d < 4; ++d) {
+                size_t nd = head.grid.axis[d].n;
+                if (nd < 3) continue;
+                size_t i = (k / stride[d]) % nd;
+                size_t j = min(max<size_t>(i, 1), nd - 2);
+                size_t m = k - i * stride[d] + j * stride[d];
+                const SurrogateNode &a = owned[m - stride[d]], &b = owned[m], &c = owned[m + stride[d]];
+                ct += second_difference(a.t, b.t, c.t);
+                cy += second_difference(a.y, b.y, c.y);
+                cz += second_difference(a.z, b.z, c.z);
+            }
+            curv[k].t = ct;
+            curv[k].y = cy;
+            curv[k].z = cz;
+        }
+    });
+
+    /* Cell bound: the largest corner curvature times 1/8, and times a
+     * safety factor of 4, since the second differences miss most of
+     * the curvature where a cell straddles the kink at which shots
+     * start to land short */
+    parallel_for(pool, n, 4096, [&](size_t first, size_t last) {
+        for (size_t k = first; k < last; ++k) {
+            bool lower = true;
+            for (int d = 0; d < 4; ++d) {
+                size_t nd = head.grid.axis[d].n;
+                lower = lower && (k / stride[d]) % nd + 1 < nd;
+            }
+            if (!lower) continue;
+            float et = 0.0f, ey = 0.0f, ez = 0.0f;
+            for (unsigned c = 0; c < 16; ++c) {
+                size_t m = k;
+                for (int d = 0; d < 4; ++d) m += ((c >> d) & 1u) ? stride[d] : 0;
+                et = fmax(et, curv[m].t);
+                ey = fmax(ey, curv[m].y);
+                ez = fmax(ez, curv[m].z);
+            }
+            owned[k].err_t = SURROGATE_SAFETY * 0.125f * et;
+            owned[k].err_y = SURROGATE_SAFETY * 0.125f * ey;
+            owned[k].err_z = SURROGATE_SAFETY * 0.125f * ez;
+        }
+    });
+
+    /* Validation against direct integration at random points */
+    Philox4x32 rng(0x5375727267617465ull);
+    vector<ShotLaunch> check(validation_samples);
+    for (size_t k = 0; k < check.size(); ++k) {
+        array<double, 4> u = rng.uniform({uint32_t(k), uint32_t(uint64_t(k) >> 32), 0u, 0u});
+        float p[4];
+        for (int d = 0; d < 4; ++d) {
+            const SurrogateAxis& a = head.grid.axis[d];
+            p[d] = a.lo + float(u[size_t(d)]) * (a.hi - a.lo);
+        }
+        check[k] = launch_at(origin, p);
+    }
+    vector<ShotResult> exact = simulate_shots(check, dt, physics, pool);
+    head.validation_samples = uint32_t(check.size());
+    for (size_t k = 0; k < check.size(); ++k) {
+        const ShotLaunch& s = check[k];
+        SurrogateHit hit = query(s.speed, s.elevation, s.azimuth, s.spin_z);
+        float t, y, z;
+        crossing(exact[k], t, y, z);
+        if (!(t == t) || !(hit.t == hit.t)) continue;
+
+        float et = fabs(hit.t - t), ey = fabs(hit.y - y), ez = fabs(hit.z - z);
+        head.max_error_t = max(head.max_error_t, et);
+        head.max_error_y = max(head.max_error_y, ey);
+        head.max_error_z = max(head.max_error_z, ez);
+        if (et > hit.err_t || ey > hit.err_y || ez > hit.err_z) head.bound_violations++;
+        if (!hit.outcome_certain) head.uncertain_outcomes++;
+        else if (hit.outcome != exact[k].outcome) head.outcome_mismatches++;
+    }
+}
+
+bool ShotSurrogate::save(const string& filename) const {
+    if (!node) return false;
+    ofstream out(filename, ios::binary);
+    if (!out) return false;
+
+    char pad[SURROGATE_ALIGN] = {0};
+    out.write(reinterpret_cast<const char*>(&head), sizeof(head));
+    out.write(pad, streamsize(head.data_offset - sizeof(head)));
+    out.write(reinterpret_cast<const char*>(node), streamsize(head.nodes * sizeof(SurrogateNode)));
+    return bool(out);
+}
+
+bool ShotSurrogate::open(const string& filename) {
+    close();
+    SurrogateHeader h;
+    {
+        ifstream in(filename, ios::binary);
+        if (!in) return false;
+        in.read(reinterpret_cast<char*>(&h), sizeof(h));
+        if (!in || memcmp(h.magic, SURROGATE_MAGIC, sizeof(h.magic)) != 0 || h.version != SURROGATE_VERSION) {
+            return false;
+        }
+        uint64_t nodes = 1;
+        for (const SurrogateAxis& a : h.grid.axis) nodes *= (a.n >= 2) ? a.n : 0;
+        if (nodes == 0 || nodes != h.nodes || h.data_offset < sizeof(h)) return false;
+    }
+    size_t bytes = size_t(h.data_offset + h.nodes * sizeof(SurrogateNode));
+
+#ifdef SURROGATE_MMAP
+    int fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+    struct stat st;
+    void* p = MAP_FAILED;
+    if (fstat(fd, &st) == 0 && size_t(st.st_size) >= bytes) p = mmap(nullptr, bytes, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (p == MAP_FAILED) return false;
+    mapped = p;
+    mapped_size = bytes;
+    node = reinterpret_cast<const SurrogateNode*>(static_cast<const char*>(p) + h.data_offset);
+#else
+    ifstream in(filename, ios::binary);
+    in.seekg(streamoff(h.data_offset));
+    owned.resize(size_t(h.nodes));
+    in.read(reinterpret_cast<char*>(owned.data()), streamsize(h.nodes * sizeof(SurrogateNode)));
+    if (!in) {
+        owned.clear();
+        return false;
+    }
+    node = owned.data();
+#endif
+
+    head = h;
+    index();
+    return true;
+}
+
+void ShotSurrogate::close() {
+#ifdef SURROGATE_MMAP
+    if (mapped) munmap(mapped, mapped_size);
+#endif
+    mapped = nullptr;
+    mapped_size = 0;
+    owned = vector<SurrogateNode>();
+    node = nullptr;
+}
+
+BallPhysics ShotSurrogate::physics() const {
+    BallPhysics p;
+    p.drag = (head.physics & 1u) != 0;
+    p.magnus = (head.physics & 2u) != 0;
+    return p;
+}
+
+/* Row-major strides and reciprocal spacings of the grid */
+void ShotSurrogate::index() {
+    size_t s = 1;
+    for (int d = 3; d >= 0; --d) {
+        stride[d] = s;
+        s *= head.grid.axis[d].n;
+        inv_step[d] = 1.0f / head.grid.axis[d].step();
+    }
+}
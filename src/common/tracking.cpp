@@ -0,0 +1,46 @@
+#include <fstream>
+#include <sstream>
+#include "tracking.hpp"
+
+using namespace std;
+
+/* Read a file with position timeseries data formatted
+ * in 3 space-separated columns:
+ * t x y
+ * and return the numerical data in the form of a single
+ * valarray of size N*3. The data is read line-by line,
+ * so that the value of row i and column j is stored in
+ * the (3*i + j)-th component of the valarray
+ */
+valarray<float> read_tracking_data(const string& filename) {
+    ifstream file(filename);
+    if (!file.is_open()) {
+        cerr << "Error: Unable to open file " << filename << endl;
+        return valarray<float>();
+    }
+
+    vector<float> data; // Use vector so we can .push_back()
+
+    string line;
+    int row = 0;
+    while (getline(file, line)) {
+        stringstream ss(line);
+        string cell;
+        int col=0;
+        while (getline(ss, cell, ' ') && col < 3) {
+            try {
+                data.push_back(stof(cell)); // read as float
+            } catch (const invalid_argument& e) {
+                cerr << "Error: Invalid data in file " << filename << " at row " << row << endl;
+                return valarray<float>();
+            }
+            ++col;
+        }
+        ++row;
+    }
+
+    // Copy data of vector into valarray and return it
+    valarray<float> valdata(data.data(), data.size());
+
+    return valdata;
+}
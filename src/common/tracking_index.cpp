@@ -0,0 +1,202 @@
+#include <cfloat>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include "interp.hpp"
+#include "tracking_index.hpp"
+
+using namespace std;
+namespace fs = std::filesystem;
+
+static const char INDEX_MAGIC[8] = {'T', 'R', 'K', 'I', 'D', 'X', '0', '1'};
+
+/* Size and modification time that a sidecar must match */
+static bool file_stamp(const string& filename, uint64_t& size, int64_t& mtime) {
+    error_code ec;
+    uintmax_t sz = fs::file_size(filename, ec);
+    if (ec) return false;
+    fs::file_time_type mt = fs::last_write_time(filename, ec);
+    if (ec) return false;
+    size = uint64_t(sz);
+    mtime = int64_t(mt.time_since_epoch().count());
+    return true;
+}
+
+TrackingIndex build_tracking_index(const string& filename, uint64_t block) {
+    TrackingIndex idx;
+    idx.block = block ? block : 1;
+
+    ifstream file(filename, ios::binary);
+    if (!file.is_open() || !file_stamp(filename, idx.file_size, idx.file_mtime)) {
+        cerr << "Error: Unable to open file " << filename << endl;
+        return idx;
+    }
+
+    vector<float> tb;
+    float t_prev = 0.0f, t_last = 0.0f;
+    float dt_min = 0.0f, dt_max = 0.0f;
+
+    string line;
+    uint64_t pos = 0;
+    while (getline(file, line)) {
+        uint64_t line_start = pos;
+        pos += line.size() + 1;
+
+        char* end;
+        float t = strtof(line.c_str(), &end);
+        if (end == line.c_str()) continue;   // blank or malformed line
+
+        if (idx.frames % idx.block == 0) {
+            idx.offset.push_back(line_start);
+            tb.push_back(t);
+        }
+        if (idx.frames == 0) {
+            idx.t_first = t;
+        } else {
+            float d = t - t_prev;
+            if (idx.frames == 1 || d < dt_min) dt_min = d;
+            if (idx.frames == 1 || d > dt_max) dt_max = d;
+        }
+        t_prev = t_last = t;
+        idx.frames++;
+    }
+
+    idx.t_block = valarray<float>(tb.data(), tb.size());
+    if (idx.frames > 1) {
+        idx.dt = (t_last - idx.t_first) / float(idx.frames - 1);
+        /* Allow for the float resolution of large timestamps */
+        float jitter = 1e-3f * idx.dt + 8.0f * FLT_EPSILON * fabs(t_last);
+        idx.uniform = dt_min > 0.0f && (dt_max - dt_min) <= jitter;
+    }
+
+    return idx;
+}
+
+bool save_tracking_index(const string& idxfile, const TrackingIndex& idx) {
+    ofstream out(idxfile, ios::binary);
+    if (!out) return false;
+
+    uint64_t nblocks = idx.offset.size();
+    uint8_t uniform = idx.uniform ? 1 : 0;
+    out.write(INDEX_MAGIC, sizeof(INDEX_MAGIC));
+    out.write(reinterpret_cast<const char*>(&idx.file_size), sizeof(idx.file_size));
+    out.write(reinterpret_cast<const char*>(&idx.file_mtime), sizeof(idx.file_mtime));
+    out.write(reinterpret_cast<const char*>(&idx.frames), sizeof(idx.frames));
+    out.write(reinterpret_cast<const char*>(&idx.block), sizeof(idx.block));
+    out.write(reinterpret_cast<const char*>(&uniform), sizeof(uniform));
+    out.write(reinterpret_cast<const char*>(&idx.t_first), sizeof(idx.t_first));
+    out.write(reinterpret_cast<const char*>(&idx.dt), sizeof(idx.dt));
+    out.write(reinterpret_cast<const char*>(&nblocks), sizeof(nblocks));
+    if (nblocks) {
+        out.write(reinterpret_cast<const char*>(idx.offset.data()), streamsize(nblocks * sizeof(uint64_t)));
+        out.write(reinterpret_cast<const char*>(&idx.t_block[0]), streamsize(nblocks * sizeof(float)));
+    }
+    return bool(out);
+}
+
+bool load_tracking_index(const string& idxfile, TrackingIndex& idx) {
+    ifstream in(idxfile, ios::binary);
+    if (!in) return false;
+
+    char magic[sizeof(INDEX_MAGIC)];
+    in.read(magic, sizeof(magic));
+    if (!in || memcmp(magic, INDEX_MAGIC, sizeof(magic)) != 0) return false;
+
+    uint64_t nblocks = 0;
+    uint8_t uniform = 0;
+    in.read(reinterpret_cast<char*>(&idx.file_size), sizeof(idx.file_size));
+    in.read(reinterpret_cast<char*>(&idx.file_mtime), sizeof(idx.file_mtime));
+    in.read(reinterpret_cast<char*>(&idx.frames), sizeof(idx.frames));
+    in.read(reinterpret_cast<char*>(&idx.block), sizeof(idx.block));
+    in.read(reinterpret_cast<char*>(&uniform), sizeof(uniform));
+    in.read(reinterpret_cast<char*>(&idx.t_first), sizeof(idx.t_first));
+    in.read(reinterpret_cast<char*>(&idx.dt), sizeof(idx.dt));
+    in.read(reinterpret_cast<char*>(&nblocks), sizeof(nblocks));
+    if (!in || idx.block == 0 || nblocks != (idx.frames + idx.block - 1) / idx.block) return false;
+
+    idx.uniform = uniform != 0;
+    idx.offset.resize(nblocks);
+    idx.t_block.resize(nblocks);
+    if (nblocks) {
+        in.read(reinterpret_cast<char*>(idx.offset.data()), streamsize(nblocks * sizeof(uint64_t)));
+        in.read(reinterpret_cast<char*>(&idx.t_block[0]), streamsize(nblocks * sizeof(float)));
+    }
+    return bool(in);
+}
+
+TrackingIndex open_tracking_index(const string& filename) {
+    string idxfile = filename + ".idx";
+
+    TrackingIndex idx;
+    uint64_t size;
+    int64_t mtime;
+    if (file_stamp(filename, size, mtime) && load_tracking_index(idxfile, idx)
+        && idx.file_size == size && idx.file_mtime == mtime) {
+        return idx;
+    }
+
+    idx = build_tracking_index(filename);
+    if (idx.frames > 0 && !save_tracking_index(idxfile, idx)) {
+        cerr << "Warning: could not write index " << idxfile << endl;
+    }
+    return idx;
+}
+
+valarray<float> read_tracking_window(const string& filename, const TrackingIndex& idx,
+                                     float t0, float t1) {
+    if (idx.frames == 0 || t1 < t0) return valarray<float>();
+
+    /* Block that starts at or before the first requested frame. The
+     * uniform estimate is backed off by two frames to absorb rounding
+     * of the timestamps; the scan below discards frames before t0. */
+    size_t b = 0;
+    if (t0 > idx.t_block[0]) {
+        if (idx.uniform) {
+            float k = floor((t0 - idx.t_first) / idx.dt) - 2.0f;
+            b = (k > 0.0f) ? min(size_t(k) / idx.block, idx.offset.size() - 1) : 0;
+            /* "uniform" only bounds consecutive gaps; over a long file
+             * the small deviations add up, so correct the estimate
+             * against the block start times */
+            while (b > 0 && idx.t_block[b] > t0) b--;
+            while (b + 1 < idx.t_block.size() && idx.t_block[b + 1] <= t0) b++;
+        } else if (t0 >= idx.t_block[idx.t_block.size() - 1]) {
+            b = idx.t_block.size() - 1;
+        } else {
+            b = size_t(locate(idx.t_block, t0, false));
+        }
+    }
+
+    ifstream file(filename, ios::binary);
+    if (!file.is_open()) {
+        cerr << "Error: Unable to open file " << filename << endl;
+        return valarray<float>();
+    }
+    file.seekg(streamoff(idx.offset[b]));
+
+    vector<float> data;
+    string line;
+    while (getline(file, line)) {
+        const char* p = line.c_str();
+        char* end;
+        float row[3];
+        int col = 0;
+        for (; col < 3; ++col) {
+            row[col] = strtof(p, &end);
+            if (end == p) break;
+            p = end;
+        }
+        if (col == 0) continue;
+        if (col < 3) {
+            cerr << "Error: Invalid data in file " << filename << " near t = " << row[0] << endl;
+            return valarray<float>();
+        }
+        if (row[0] < t0) continue;
+        if (row[0] > t1) break;
+        data.insert(data.end(), row, row + 3);
+    }
+
+    return valarray<float>(data.data(), data.size());
+}
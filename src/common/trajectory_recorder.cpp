@@ -0,0 +1,100 @@
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include "trajectory_recorder.hpp"
+
+using namespace std;
+
+static const char TRAJECTORY_MAGIC[8] = {'T', 'R', 'A', 'J', 'B', 'I', 'N', '1'};
+static const uint32_t TRAJECTORY_VERSION = 1;
+static const size_t BINARY_BUFFER_ROWS = 4096;
+
+TextTrajectorySink::TextTrajectorySink(ostream& os, size_t buffer_bytes) : out(os), capacity(buffer_bytes) {
+    buffer.reserve(capacity + 256);
+}
+
+TextTrajectorySink::~TextTrajectorySink() { flush(); }
+
+void TextTrajectorySink::write(const float* row, size_t columns) {
+    char field[32];
+    for (size_t i = 0; i < columns; ++i) {
+        // "%g" is the default formatting of a float inserted into a stream
+        int n = snprintf(field, sizeof(field), i ? " %g" : "%g", double(row[i]));
+        buffer.append(field, size_t(n));
+    }
+    buffer.push_back('\n');
+    if (buffer.size() >= capacity) flush();
+}
+
+void TextTrajectorySink::flush() {
+    if (!buffer.empty()) out.write(buffer.data(), streamsize(buffer.size()));
+    buffer.clear();
+    out.flush();
+}
+
+BinaryTrajectorySink::BinaryTrajectorySink(ostream& os, size_t columns) : out(os) {
+    TrajectoryFileHeader h;
+    memcpy(h.magic, TRAJECTORY_MAGIC, sizeof(h.magic));
+    h.version = TRAJECTORY_VERSION;
+    h.columns = uint32_t(columns);
+    out.write(reinterpret_cast<const char*>(&h), sizeof(h));
+    buffer.reserve(BINARY_BUFFER_ROWS * columns);
+}
+
+BinaryTrajectorySink::~BinaryTrajectorySink() { flush(); }
+
+void BinaryTrajectorySink::write(const float* row, size_t columns) {
+    buffer.insert(buffer.end(), row, row + columns);
+    if (buffer.size() >= BINARY_BUFFER_ROWS * columns) flush();
+}
+
+void BinaryTrajectorySink::flush() {
+    if (!buffer.empty()) {
+        out.write(reinterpret_cast<const char*>(buffer.data()), streamsize(buffer.size() * sizeof(float)));
+    }
+    buffer.clear();
+    out.flush();
+}
+
+bool read_trajectory_binary(const string& filename, vector<float>& rows, size_t& columns) {
+    ifstream in(filename, ios::binary);
+    TrajectoryFileHeader h;
+    in.read(reinterpret_cast<char*>(&h), sizeof(h));
+    if (!in || memcmp(h.magic, TRAJECTORY_MAGIC, sizeof(h.magic)) != 0 || h.version != TRAJECTORY_VERSION ||
+        h.columns == 0) {
+        return false;
+    }
+    columns = h.columns;
+
+    in.seekg(0, ios::end);
+    streamoff bytes = streamoff(in.tellg()) - streamoff(sizeof(h));
+    in.seekg(streamoff(sizeof(h)));
+    size_t n = size_t(bytes) / (sizeof(float) * columns);
+    rows.resize(n * columns);
+    in.read(reinterpret_cast<char*>(rows.data()), streamsize(rows.size() * sizeof(float)));
+    return bool(in);
+}
+
+bool parse_record_policy(const string& spec, RecordPolicy& policy) {
+    size_t colon = spec.find(':');
+    string mode = spec.substr(0, colon);
+    const char* arg = (colon == string::npos) ? nullptr : spec.c_str() + colon + 1;
+    char* end = nullptr;
+
+    if (mode == "none" && !arg) {
+        policy = RecordPolicy::none();
+    } else if (mode == "events" && !arg) {
+        policy = RecordPolicy::events();
+    } else if (mode == "every") {
+        long k = arg ? strtol(arg, &end, 10) : 1;
+        if ((arg && *end) || k < 1) return false;
+        policy = RecordPolicy::every_step(int(k));
+    } else if (mode == "rate" && arg) {
+        double dt = strtod(arg, &end);
+        if (*end || !(dt > 0.0)) return false;
+        policy = RecordPolicy::resample(dt);
+    } else {
+        return false;
+    }
+    return true;
+}
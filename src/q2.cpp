@@ -8,51 +8,11 @@
 #include <cmath>
 #include "q234.hpp"
 #include "interp.hpp"
+#include "tracking.hpp"
+#include "kalman.hpp"
 
 using namespace std;
 
-/* Read a file with position timeseries data formatted
- * in 3 space-separated columns:
- * t x y
- * and return the numerical data in the form of a single
- * valarray of size N*3. The data is read line-by line,
- * so that the value of row i and column j is stored in
- * the (3*i + j)-th component of the valarray
- */
-valarray<float> read_tracking_data(const string& filename) {
-    ifstream file(filename);
-    if (!file.is_open()) {
-        cerr << "Error: Unable to open file " << filename << endl;
-        return valarray<float>();
-    }
-
-    vector<float> data; // Use vector so we can .push_back()
-
-    string line;
-    int row = 0;
-    while (getline(file, line)) {
-        stringstream ss(line);
-        string cell;
-        int col=0;
-        while (getline(ss, cell, ' ') && col < 3) {
-            try {
-                data.push_back(stof(cell)); // read as float
-            } catch (const invalid_argument& e) {
-                cerr << "Error: Invalid data in file " << filename << " at row " << row << endl;
-                return valarray<float>();
-            }
-            ++col;
-        }
-        ++row;
-    }
-
-    // Copy data of vector into valarray and return it
-    valarray<float> valdata(data.data(), data.size());
-
-    return valdata;
-}
-
-
 /* Add your functions here */
 
 // Q2(a): Transform normalised to physical pitch coordinates (centre at origin)
@@ -122,6 +82,22 @@ int main(int argc, char *argv[]) {
     cout << "v_mag.size() = " << v_mag.size() << " (1001 - 2 = 999(Length of v_mag))" << endl;
     cout << "a_mag.size() = " << a_mag.size() << " (999 - 2 = 997(Length of a_mag))" << endl;
 
+    // Kalman/RTS smoothing: position, velocity and acceleration estimated
+    // directly from the positions instead of chaining two noisy differences
+    KinematicTrack kin = kalman_smooth<3>(t_varr, x_phys, y_phys, KALMAN_Q_PLAYER, KALMAN_R_TRACKING);
+    valarray<float> v_kf = sqrt(kin.vx * kin.vx + kin.vy * kin.vy);
+    valarray<float> a_kf = sqrt(kin.ax * kin.ax + kin.ay * kin.ay);
+
+    ofstream kffile("player_speed_kf.dat");
+    kffile << fixed << setprecision(6);
+    for (size_t i = 0; i < v_kf.size(); ++i) {
+        kffile << kin.t[i] << " " << v_kf[i] << " " << a_kf[i] << endl;
+    }
+    kffile.close();
+
+    cout << "Kalman-smoothed maximum speed: " << v_kf.max() << " m/s, "
+         << "maximum acceleration: " << a_kf.max() << " m/s^2" << endl;
+
     // Q2(f): Conceptual part — not coded, but here’s the answer
     cout << "\nQ2(f): To reconstruct smooth motion at 120Hz from 5Hz data,\n"
          << "we would use cubic interpolation to estimate the player’s\n"
@@ -5,29 +5,13 @@
 #include <sstream>
 #include <string>
 #include "interp.hpp"
+#include "quadrature.hpp"
+#include "energy_kernel.hpp"
+#include "romberg.hpp"
+#include "prefix_integral.hpp"
 
 using namespace std;
 
-// Question 3(e): Composite 4-point Newton-Cotes integration
-// Implements a 4-point Newton-Cotes rule: evaluates a composite integral of equally spaced values
-// Assumes N = 3k + 1, i.e. the number of intervals is a multiple of 3
-float integrate_newton_cotes_4(const valarray<float>& f, float h) {
-    size_t N = f.size();
-    if (N < 4 || (N - 1) % 3 != 0) {
-        cerr << "Error: Data size must be 3k+1 for 4-point Newton-Cotes rule.\n";
-        return -1.0f;
-    }
-
-    float result = 0.0f;
-    for (size_t i = 0; i < N - 1; i += 3) {
-        // Applies the 4-point Newton-Cotes weight formula on each 3-interval group
-        result += (3.0f * h / 8.0f) *
-            (f[i] + 3.0f * f[i + 1] + 3.0f * f[i + 2] + f[i + 3]);
-    }
-
-    return result;
-}
-
 int main() {
     // Question 3(a): Interpolation of P(v)
     valarray<float> v_table = {0.0f, 3.0f, 5.0f, 8.0f};         // velocity samples
@@ -77,24 +61,35 @@ int main() {
     // Question 3(d): Compute energy using trapezoidal rule
     float dt = 0.2f; // time step
 
-    float energy_spent = dt * (
-        0.5f * p_i[0] +
-        valarray<float>(p_i[slice(1, p_i.size() - 2, 1)]).sum() +
-        0.5f * p_i[p_i.size() - 1]
-    ); // Trapezoidal integration
+    // Trapezoidal integration fused with the evaluation of P(v): the
+    // Newton form of the same cubic is applied to each speed sample
+    // as it is summed, so no power array is needed
+    PowerPolynomial<4> power_curve(v_table, P_table);
+    float energy_spent = float(integrate_power(v_data, dt, power_curve, 2));
 
     cout << "\nTotal energy spent by player A over "
          << t_data[t_data.size() - 1] << " seconds is "
          << fixed << setprecision(2) << energy_spent << " J" << endl;
 
     // Question 3(e): Newton-Cotes 4-point integration
-    // Only evaluate if data size is compatible with rule (N = 3k+1)
-    if ((p_i.size() - 1) % 3 == 0) {
-        float energy_nc4 = integrate_newton_cotes_4(p_i, dt);
-        cout << "Energy using 4-point Newton-Cotes rule: "
-             << fixed << setprecision(2) << energy_nc4 << " J" << endl;
-    } else {
-        cout << "Warning: p_i size incompatible with 4-point Newton-Cotes rule (must be 3k+1)." << endl;
+    // (any N: sizes other than 3k+1 are closed with a higher-order tail panel)
+    float energy_nc4 = float(integrate_power(v_data, dt, power_curve, 4));
+    cout << "Energy using 4-point Newton-Cotes rule: "
+         << fixed << setprecision(2) << energy_nc4 << " J" << endl;
+
+    // Romberg extrapolation of trapezoid sums on stride-2^k subsamples
+    QuadResult energy_romberg = romberg<float>(p_i, dt);
+    cout << "Energy using Romberg extrapolation: "
+         << fixed << setprecision(2) << energy_romberg.value << " J (error estimate "
+         << energy_romberg.error << " J)" << endl;
+
+    // Energy per 50 s window from one cumulative-integral pass (O(1) per window)
+    PrefixIntegral energy_index(p_i, t_data[0], dt, PrefixRule::Cubic);
+    cout << "\nEnergy per 50 s window:" << endl;
+    for (double t_win = energy_index.t_start(); t_win < energy_index.t_end(); t_win += 50.0) {
+        double t_stop = min(t_win + 50.0, energy_index.t_end());
+        cout << "  [" << t_win << ", " << t_stop << "] s: "
+             << energy_index.integral(t_win, t_stop) << " J" << endl;
     }
 
     return 0;
@@ -1,53 +1,200 @@
 #include <iostream>
 #include <fstream>
 #include <sstream>
+#include <memory>
+#include <string>
+#include <vector>
 #include <valarray>
 #include <cmath>
 #include <cstdlib>
 #include "q234.hpp"
+#include "butcher.hpp"
+#include "dopri45.hpp"
+#include "ode_events.hpp"
+#include "ball_forces.hpp"
+#include "symplectic.hpp"
+#include "ode.hpp"
+#include "trajectory_recorder.hpp"
 
 using namespace std;
 
+// Force model of the shot: gravity, drag and Magnus lift from the spin
+// about the z-axis. The terms are part of the type, so e.g.
+// ForceModel<Gravity, Drag<> > compiles to an rhs without Magnus.
+typedef ForceModel<Gravity, Drag<>, Magnus<SpinZ> > ShotForces;
+
+static ShotForces shot_forces(double wz) {
+    return make_force_model(Gravity(), Drag<>(), Magnus<SpinZ>{SpinZ{wz}});
+}
+
 // RHS of the ODE system: gravity, drag, Magnus
-valarray<float> rhs(float t, valarray<float> Y) {
-    valarray<float> dY(6);
-    float vx = Y[3], vy = Y[4], vz = Y[5];
-    float v_mag = sqrt(vx * vx + vy * vy + vz * vz); // speed magnitude
-
-    float ax = 0.0f, ay = 0.0f, az = -A_GRAV; // default gravity acceleration
-
-    // Air resistance (drag), acts opposite to velocity direction
-    if (drag_on) {
-        float A = M_PI * R_BALL * R_BALL;
-        float drag_coeff = 0.5f * C_DRAG * RHO_AIR * A / M_BALL;
-        ax += -drag_coeff * v_mag * vx;
-        ay += -drag_coeff * v_mag * vy;
-        az += -drag_coeff * v_mag * vz;
-    }
+template<class T>
+void rhs(T t, const BallStateOf<T>& Y, BallStateOf<T>& dY) {
+    static const ShotForces forces = shot_forces(OMEGA_Z);
+    forces(t, Y, dY);
+}
 
-    // Magnus effect (lift due to spin), applied perpendicularly to velocity and spin
-    if (magnus_on) {
-        float wz = omega[2]; // spin along z-axis
-        float magnus_term = S_MAGN / M_BALL;
-        ax += magnus_term * wz * vy;
-        ay += -magnus_term * wz * vx;
+template void rhs(float, const BallStateOf<float>&, BallStateOf<float>&);
+template void rhs(double, const BallStateOf<double>&, BallStateOf<double>&);
+
+// Recorded rows hold the height of the ball above the ground
+struct HeightAboveGround {
+    void operator()(BallState& S) const { S[2] = float(S[2] - R_BALL); }
+};
+
+typedef TrajectoryRecorder<BallState, HeightAboveGround> ShotRecorder;
+
+// Fly the shot with any solver of ode.hpp until a terminal event: the
+// events are located on the solver's dense output after every step,
+// then the step goes to the recorder. (t, Y) is set to the end of the
+// last step; returns the rhs() calls made.
+template<class Solver>
+static size_t fly(Solver& solver, float& t, BallState& Y, EventLocator<BallState>& events, ShotRecorder& recorder) {
+    size_t hits_recorded = 0;
+    auto located = [&](const Solver& s) {
+        return events.check(s.t(), s.state(), [&](float x, BallState& S) { s.dense(x, S); });
+    };
+    auto record = [&](const Solver& s) {
+        for (; hits_recorded < events.hits().size(); ++hits_recorded) {
+            const EventHit<BallState>& hit = events.hits()[hits_recorded];
+            if (!hit.terminal) recorder.event(hit.t, hit.y);
+        }
+        bool stop = events.terminated();
+        recorder.step(stop ? events.terminal_event().t : s.t(), s.state(),
+                      [&](float x, BallState& S) { s.dense(x, S); }, stop);
+    };
+    integrate(solver, T_FLIGHT_MAX, record, located);
+    t = solver.t();
+    Y = solver.state();
+    return solver.evaluations();
+}
+
+// The integration with one method from (t, Y), which it advances; the
+// force model is inlined into the stepper loop of every instantiation
+typedef size_t (*ShotFlight)(const ShotForces&, float&, BallState&, float, EventLocator<BallState>&, ShotRecorder&);
+
+template<class Method>
+static size_t fly_fixed(const ShotForces& forces, float& t, BallState& Y, float dt, EventLocator<BallState>& events,
+                        ShotRecorder& recorder) {
+    FixedStepSolver<Method, BallState, ShotForces> solver(forces, t, Y, dt);
+    return fly(solver, t, Y, events, recorder);
+}
+
+// Dormand-Prince RK45: the step size follows the error estimate and the
+// recorder resamples the dense output (by default on the dt grid),
+// which costs no extra rhs() calls
+static size_t fly_rk45(const ShotForces& forces, float& t, BallState& Y, float, EventLocator<BallState>& events,
+                       ShotRecorder& recorder) {
+    DoPriOptions opt;
+    opt.abs_tol = 1e-5;
+    opt.rel_tol = 1e-6;
+    DormandPrince45<BallState, ShotForces> solver(forces, t, Y, opt);
+    return fly(solver, t, Y, events, recorder);
+}
+
+static ShotFlight find_flight(const string& name) {
+    if (name == "rk4") return fly_fixed<RK4Step>;
+    if (name == "rk45") return fly_rk45;
+    if (name == ButcherRK6::name) return fly_fixed<ButcherRK6>;
+    if (name == CooperVerner8::name) return fly_fixed<CooperVerner8>;
+    if (name == GaussLegendreRK4::name) return fly_fixed<GaussLegendreRK4>;
+    if (name == GaussLegendreRK6::name) return fly_fixed<GaussLegendreRK6>;
+    if (name == VelocityVerlet::name) return fly_fixed<VelocityVerlet>;
+    if (name == Yoshida4::name) return fly_fixed<Yoshida4>;
+    return nullptr;
+}
+
+// Plan the step of every fixed-step method for position error tol
+// (in double, over the drag-free time to the goal line) and return the
+// cheapest in rhs() calls
+template<class Method>
+static void plan_method(const ShotForces& forces, const BallState& Y, double t1, double tol,
+                        string& best, double& best_dt, long& best_evals) {
+    array<double, 6> y0;
+    for (size_t i = 0; i < y0.size(); ++i) y0[i] = Y[i];
+    StepPlan plan = plan_fixed_steps<Method>(forces, 0.0, y0, t1, tol);
+    cerr << "  " << Method::name << ": " << plan.steps << " steps, " << plan.evaluations << " rhs calls, error "
+         << plan.error << ", order " << plan.order << (plan.converged ? "" : " (not converged)") << "\n";
+    if (plan.converged && (best.empty() || plan.evaluations < best_evals)) {
+        best = Method::name;
+        best_dt = plan.h;
+        best_evals = plan.evaluations;
     }
+}
+
+static string plan_stepper(const ShotForces& forces, const BallState& Y, double tol, float& dt) {
+    double t1 = min(double(T_FLIGHT_MAX), (PITCH_L / 2 - Y[0]) / max(double(Y[3]), 1.0));
+    string best;
+    double best_dt = dt;
+    long best_evals = 0;
+    cerr << "Fixed-step plans for error " << tol << " m over " << t1 << " s:\n";
+    plan_method<ClassicRK4>(forces, Y, t1, tol, best, best_dt, best_evals);
+    plan_method<ButcherRK6>(forces, Y, t1, tol, best, best_dt, best_evals);
+    plan_method<CooperVerner8>(forces, Y, t1, tol, best, best_dt, best_evals);
+    plan_method<GaussLegendreRK4>(forces, Y, t1, tol, best, best_dt, best_evals);
+    plan_method<GaussLegendreRK6>(forces, Y, t1, tol, best, best_dt, best_evals);
+    plan_method<VelocityVerlet>(forces, Y, t1, tol, best, best_dt, best_evals);
+    plan_method<Yoshida4>(forces, Y, t1, tol, best, best_dt, best_evals);
+    dt = float(best_dt);
+    return best.empty() ? string("rk4") : best;
+}
+
+// valarray form, kept for existing callers
+valarray<float> rhs(float t, valarray<float> Y) {
+    BallState y, dy;
+    for (size_t i = 0; i < y.size(); ++i) y[i] = Y[i];
+    rhs(t, y, dy);
+    return valarray<float>(dy.data(), dy.size());
+}
+
+// N RK4 steps of the rhs() above (see ode.hpp)
+template<class T>
+BallStateOf<T> rk4(T t0, BallStateOf<T> y0, T h, int N) {
+    auto f = [](T t, const BallStateOf<T>& Y, BallStateOf<T>& dY) { rhs(t, Y, dY); };
+    integrate_fixed<RK4Step>(f, t0, y0, h, t0 + T(N) * h);
+    return y0;
+}
 
-    dY[0] = vx;
-    dY[1] = vy;
-    dY[2] = vz;
-    dY[3] = ax;
-    dY[4] = ay;
-    dY[5] = az;
+template BallStateOf<float> rk4(float, BallStateOf<float>, float, int);
+template BallStateOf<double> rk4(double, BallStateOf<double>, double, int);
 
-    return dY;
+// valarray form, kept for existing callers
+valarray<float> rk4(float t0, valarray<float> y0, float h, int N) {
+    BallState y;
+    for (size_t i = 0; i < y.size(); ++i) y[i] = y0[i];
+    y = rk4(t0, y, h, N);
+    return valarray<float>(y.data(), y.size());
 }
 
 int main(int argc, char* argv[]) {
+    // Options: --record none|every:K|events|rate:DT (default: every step
+    // for the fixed-step methods, the dt grid for rk45), --binary for a
+    // binary record file instead of text, --echo to copy the rows to stdout
+    vector<string> args;
+    string record_spec;
+    bool binary = false, echo = false;
+    for (int i = 1; i < argc; ++i) {
+        string arg = argv[i];
+        if (arg == "--record" && i + 1 < argc) record_spec = argv[++i];
+        else if (arg == "--binary") binary = true;
+        else if (arg == "--echo") echo = true;
+        else args.push_back(arg);
+    }
+
     float v0 = 25.0f;
-    if (argc > 1) v0 = atof(argv[1]); // allows command-line velocity override
+    if (args.size() > 0) v0 = atof(args[0].c_str()); // allows command-line velocity override
+    // rk45: adaptive Dormand-Prince; rk4 (default), rk6, rk8, gl4, gl6,
+    // verlet, yoshida4: fixed steps of that method; auto: the fixed-step
+    // method with the fewest rhs() calls for the error given instead of dt
+    string method = (args.size() > 1) ? args[1] : "rk4";
+    bool adaptive = (method == "rk45");
 
     float t = 0.0f, dt = 0.01f;
+    double tol = 1e-4;
+    if (args.size() > 2) {
+        if (method == "auto") tol = atof(args[2].c_str());
+        else dt = atof(args[2].c_str()); // step and output interval
+    }
     float angle = 20.0f * M_PI / 180.0f; // convert degrees to radians
     float x0 = PITCH_L / 2 - 20.0f;      // 20m from goal line
     float y0 = 3.0f;                     // 3m left from center
@@ -56,48 +203,71 @@ int main(int argc, char* argv[]) {
     float vy0 = 0.0f;
     float vz0 = v0 * sin(angle);
 
-    valarray<float> Y = {x0, y0, z0, vx0, vy0, vz0};
+    BallState Y = {x0, y0, z0, vx0, vy0, vz0};
+    ShotForces forces = shot_forces(OMEGA_Z);
 
-    // Print initial state to stdout with z adjusted to start from 0
-    cout << t << " " << Y[0] << " " << Y[1] << " " << (Y[2] - R_BALL)
-         << " " << Y[3] << " " << Y[4] << " " << Y[5] << "\n";
-
-    // Output file name depends on enabled physics
-    ostringstream fname;
-    fname << "v" << int(v0);
-    if (drag_on) fname << "_drag";
-    if (magnus_on) fname << "_magnus";
-    fname << ".dat";
-
-    ofstream fout(fname.str());
-    if (!fout) {
-        cerr << "Error: could not open output file.\n";
+    if (method == "auto") method = plan_stepper(forces, Y, tol, dt);
+    ShotFlight flight = find_flight(method);
+    if (!flight) {
+        cerr << "Error: unknown method " << method << "\n";
         return 1;
     }
 
-    // Initial line to output file (z adjusted to zero level)
-    fout << t << " " << Y[0] << " " << Y[1] << " " << (Y[2] - R_BALL)
-         << " " << Y[3] << " " << Y[4] << " " << Y[5] << "\n";
+    RecordPolicy policy = adaptive ? RecordPolicy::resample(dt) : RecordPolicy::every_step();
+    if (!record_spec.empty() && !parse_record_policy(record_spec, policy)) {
+        cerr << "Error: unknown recording policy " << record_spec << "\n";
+        return 1;
+    }
 
-    // RK4 integration loop until ball hits ground or passes goal line
-    while (Y[0] < PITCH_L / 2 && Y[2] > R_BALL) {
-        Y = rk4(t, Y, dt, 1);
-        t += dt;
+    // Output file name depends on enabled physics
+    ostringstream fname;
+    fname << "v" << int(v0) << ShotForces::tag() << (binary ? ".bin" : ".dat");
 
-        // Write to file (z adjusted)
-        fout << t << " " << Y[0] << " " << Y[1] << " " << (Y[2] - R_BALL)
-             << " " << Y[3] << " " << Y[4] << " " << Y[5] << "\n";
+    ofstream fout;
+    if (policy.mode != RecordPolicy::None) {
+        fout.open(fname.str(), binary ? ios::out | ios::binary : ios::out);
+        if (!fout) {
+            cerr << "Error: could not open output file.\n";
+            return 1;
+        }
+    }
 
-        // Also print to stdout (raw z, not adjusted)
-        cout << t << " " << Y[0] << " " << Y[1] << " " << (Y[2] - R_BALL)
-             << " " << Y[3] << " " << Y[4] << " " << Y[5] << "\n";
+    ShotRecorder recorder(policy);
+    unique_ptr<TrajectorySink> file_sink;
+    if (fout.is_open()) {
+        if (binary) file_sink.reset(new BinaryTrajectorySink(fout, 1 + Y.size()));
+        else file_sink.reset(new TextTrajectorySink(fout));
+        recorder.add_sink(*file_sink);
     }
+    TextTrajectorySink console(cout);
+    if (echo) recorder.add_sink(console);
+    recorder.boundary(t, Y);
 
-    fout.close();
+    // Terminal events: the ball reaches the goal line (x rising through
+    // PITCH_L/2) or comes down to the ground (z falling through R_BALL).
+    // The apex (vz falling through 0) is recorded without stopping.
+    EventLocator<BallState> events;
+    const int GOAL_LINE = events.add([](float, const BallState& S) { return S[0] - float(PITCH_L / 2); },
+                                     EventDirection::Rising);
+    events.add([](float, const BallState& S) { return S[2] - float(R_BALL); }, EventDirection::Falling);
+    const int APEX = events.add([](float, const BallState& S) { return S[5]; }, EventDirection::Falling, false);
+    events.start(t, Y);
+    size_t n_rhs = flight(forces, t, Y, dt, events, recorder);
+
+    // Last line: the exact crossing state, or the state at T_FLIGHT_MAX
+    // (left in t, Y by the flight) if neither terminal event occurred
+    bool at_goal_line = false;
+    if (events.terminated()) {
+        t = events.terminal_event().t;
+        Y = events.terminal_event().y;
+        at_goal_line = (events.terminal_event().id == GOAL_LINE);
+    }
+    recorder.boundary(t, Y);
+    recorder.flush();
 
     // Print outcome analysis to stderr
     cerr << "v0 = " << v0 << " → ";
-    if (Y[0] >= PITCH_L / 2) {
+    if (at_goal_line) {
         if (Y[2] <= GOAL_H) {
             cerr << "The Shot is GOOD – under the bar.\n";
         } else {
@@ -118,6 +288,10 @@ int main(int argc, char* argv[]) {
     } else {
         cerr << "The Shot is WEAK – hit the ground before goal.\n";
     }
+    for (const EventHit<BallState>& hit : events.hits()) {
+        if (hit.id == APEX) cerr << "Apex: " << (hit.y[2] - R_BALL) << " m at t = " << hit.t << " s\n";
+    }
+    cerr << "RHS evaluations (" << method << ", dt = " << dt << "): " << n_rhs << "\n";
 
     return 0;
 }
\ No newline at end of file
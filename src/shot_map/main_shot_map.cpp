@@ -0,0 +1,76 @@
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include "q234.hpp"
+#include "ensemble.hpp"
+
+using namespace std;
+
+/* Shot-outcome map over a speed x elevation x spin grid, all shots
+ * launched from the Q4 position (20 m from the goal line, 3 m left
+ * of centre):
+ *
+ *   shot_map [outfile] [-j threads] [--dt s]
+ *
+ * Each line of outfile holds v0 (m/s), elevation (deg), spin (rad/s),
+ * the outcome and the crossing time and position. */
+int main(int argc, char* argv[]) {
+    string outfile = "shot_map.dat";
+    size_t nthreads = 0;
+    float dt = 0.01f;
+    for (int i = 1; i < argc; ++i) {
+        string arg = argv[i];
+        if (arg == "-j" && i + 1 < argc) {
+            nthreads = strtoul(argv[++i], nullptr, 10);
+        } else if (arg == "--dt" && i + 1 < argc) {
+            dt = float(atof(argv[++i]));
+        } else {
+            outfile = arg;
+        }
+    }
+
+    vector<ShotLaunch> shots;
+    for (int iv = 0; iv <= 80; ++iv) {
+        for (int ie = 0; ie <= 80; ++ie) {
+            for (int is = 0; is <= 8; ++is) {
+                ShotLaunch s;
+                s.x = float(PITCH_L / 2 - 20.0);
+                s.y = 3.0f;
+                s.z = float(R_BALL);
+                s.speed = 15.0f + 0.25f * float(iv);
+                s.elevation = float((5.0 + 0.375 * ie) * M_PI / 180.0);
+                s.azimuth = 0.0f;
+                s.spin_z = -20.0f + 5.0f * float(is);
+                shots.push_back(s);
+            }
+        }
+    }
+
+    ThreadPool pool(nthreads);
+    auto start = chrono::steady_clock::now();
+    vector<ShotResult> results = simulate_shots(shots, dt, BallPhysics(), pool);
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    ofstream fout(outfile);
+    if (!fout) {
+        cerr << "Error: could not open " << outfile << endl;
+        return 1;
+    }
+    size_t count[4] = {0, 0, 0, 0};
+    for (size_t i = 0; i < shots.size(); ++i) {
+        const ShotLaunch& s = shots[i];
+        const ShotResult& r = results[i];
+        count[int(r.outcome)]++;
+        fout << s.speed << " " << s.elevation * 180.0 / M_PI << " " << s.spin_z << " "
+             << shot_outcome_name(r.outcome) << " " << r.t << " " << r.y << " " << (r.z - R_BALL) << "\n";
+    }
+
+    cout << shots.size() << " shots in " << seconds << " s (" << double(shots.size()) / seconds
+         << " shots/s on " << pool.size() << " threads)" << endl;
+    cout << "GOOD " << count[0] << ", OVER " << count[1] << ", WEAK " << count[2]
+         << ", UNRESOLVED " << count[3] << endl;
+    return 0;
+}
@@ -0,0 +1,80 @@
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include "q234.hpp"
+#include "monte_carlo.hpp"
+
+using namespace std;
+
+/* Monte Carlo scoring probability of the Q4 shot (20 m out, 3 m left
+ * of centre, 20 degrees, spin 10 rad/s) with perturbed speed, angles,
+ * spin and drag coefficient:
+ *
+ *   shot_mc [v0] [-j threads] [--seed n] [--ci halfwidth] [--hist file]
+ *
+ * Prints the GOOD/OVER/WEAK probabilities with their confidence
+ * intervals and the spread of the crossing point on the goal plane;
+ * --hist writes the goal-plane histogram (y, z, count per line). */
+int main(int argc, char* argv[]) {
+    float v0 = 25.0f;
+    size_t nthreads = 0;
+    string hist_file;
+    MonteCarloOptions opt;
+    for (int i = 1; i < argc; ++i) {
+        string arg = argv[i];
+        if (arg == "-j" && i + 1 < argc) {
+            nthreads = strtoul(argv[++i], nullptr, 10);
+        } else if (arg == "--seed" && i + 1 < argc) {
+            opt.seed = strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--ci" && i + 1 < argc) {
+            opt.ci_halfwidth = atof(argv[++i]);
+        } else if (arg == "--hist" && i + 1 < argc) {
+            hist_file = argv[++i];
+        } else {
+            v0 = float(atof(argv[i]));
+        }
+    }
+
+    ShotLaunch nominal;
+    nominal.x = float(PITCH_L / 2 - 20.0);
+    nominal.y = 3.0f;
+    nominal.z = float(R_BALL);
+    nominal.speed = v0;
+    nominal.elevation = float(20.0 * M_PI / 180.0);
+    nominal.azimuth = 0.0f;
+    nominal.spin_z = float(OMEGA_Z);
+
+    ThreadPool pool(nthreads);
+    MonteCarloResult res = estimate_shot_outcomes(nominal, ShotSpread(), opt, pool);
+
+    const ShotOutcome outcomes[3] = {ShotOutcome::Good, ShotOutcome::Over, ShotOutcome::Weak};
+    cout << "v0 = " << v0 << " m/s, " << res.samples << " samples"
+         << (res.converged ? "" : " (confidence target not reached)") << endl;
+    cout << fixed << setprecision(4);
+    for (ShotOutcome o : outcomes) {
+        cout << "P(" << shot_outcome_name(o) << ") = " << res.probability[int(o)]
+             << " +- " << res.ci_halfwidth[int(o)] << endl;
+    }
+    cout << "Goal-plane crossing: y = " << res.mean_y << " +- " << res.sd_y
+         << " m, z = " << res.mean_z - R_BALL << " +- " << res.sd_z << " m" << endl;
+
+    if (!hist_file.empty()) {
+        ofstream fout(hist_file);
+        if (!fout) {
+            cerr << "Error: could not open " << hist_file << endl;
+            return 1;
+        }
+        const GoalPlaneHistogram& h = res.landing;
+        float dy = (h.y_max - h.y_min) / float(h.ny), dz = (h.z_max - h.z_min) / float(h.nz);
+        for (size_t iz = 0; iz < h.nz; ++iz) {
+            for (size_t iy = 0; iy < h.ny; ++iy) {
+                fout << h.y_min + (float(iy) + 0.5f) * dy << " " << h.z_min + (float(iz) + 0.5f) * dz << " "
+                     << h.counts[iz * h.ny + iy] << "\n";
+            }
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,79 @@
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include "q234.hpp"
+#include "shot_solver.hpp"
+
+using namespace std;
+
+/* Launch parameters that put the Q4 shot (20 m out, 3 m left of
+ * centre) through given points of the goal plane:
+ *
+ *   shot_solve [y z] [--free speed,elevation,azimuth,spin,drag] [-j threads]
+ *
+ * y and z are the crossing point of the ball centre in m; without them
+ * a 9 x 5 grid over the goal mouth is solved. Free parameters default
+ * to elevation and azimuth; the others keep the Q4 values. */
+int main(int argc, char* argv[]) {
+    InverseShotOptions opt;
+    size_t nthreads = 0;
+    vector<float> coords;
+    for (int i = 1; i < argc; ++i) {
+        string arg = argv[i];
+        if (arg == "-j" && i + 1 < argc) {
+            nthreads = strtoul(argv[++i], nullptr, 10);
+        } else if (arg == "--free" && i + 1 < argc) {
+            string list = argv[++i];
+            opt.free_params = 0;
+            if (list.find("speed") != string::npos) opt.free_params |= SHOT_SPEED;
+            if (list.find("elevation") != string::npos) opt.free_params |= SHOT_ELEVATION;
+            if (list.find("azimuth") != string::npos) opt.free_params |= SHOT_AZIMUTH;
+            if (list.find("spin") != string::npos) opt.free_params |= SHOT_SPIN;
+            if (list.find("drag") != string::npos) opt.free_params |= SHOT_DRAG;
+        } else {
+            coords.push_back(float(atof(argv[i])));
+        }
+    }
+
+    ShotLaunch guess;
+    guess.x = float(PITCH_L / 2 - 20.0);
+    guess.y = 3.0f;
+    guess.z = float(R_BALL);
+    guess.speed = 25.0f;
+    guess.elevation = float(20.0 * M_PI / 180.0);
+    guess.azimuth = 0.0f;
+    guess.spin_z = float(OMEGA_Z);
+
+    vector<ShotTarget> targets;
+    if (coords.size() >= 2) {
+        targets.push_back(ShotTarget{coords[0], coords[1]});
+    } else {
+        for (int iz = 0; iz < 5; ++iz)
+            for (int iy = 0; iy < 9; ++iy)
+                targets.push_back(ShotTarget{float(-GOAL_W / 2 + 0.5 + iy * (GOAL_W - 1.0) / 8),
+                                             float(R_BALL + 0.2 + iz * (GOAL_H - R_BALL - 0.4) / 4)});
+    }
+
+    ThreadPool pool(nthreads);
+    auto start = chrono::steady_clock::now();
+    vector<InverseShotResult> results = solve_shots(guess, targets, opt, pool);
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    cout << "#   y_t     z_t     v0[m/s]  elev[deg]  azim[deg]  spin[rad/s]  residual[m]  iter  status" << endl;
+    cout << fixed;
+    size_t solved = 0;
+    for (size_t i = 0; i < targets.size(); ++i) {
+        const InverseShotResult& r = results[i];
+        solved += r.converged;
+        cout << setprecision(3) << setw(7) << targets[i].y << " " << setw(7) << targets[i].z << "  "
+             << setw(8) << r.launch.speed << "  " << setw(9) << r.launch.elevation * 180.0 / M_PI << "  "
+             << setw(9) << r.launch.azimuth * 180.0 / M_PI << "  " << setw(11) << r.launch.spin_z << "  "
+             << scientific << setprecision(2) << setw(11) << r.residual << fixed << "  " << setw(4)
+             << r.iterations << "  " << (r.converged ? "ok" : "FAILED") << endl;
+    }
+    cerr << solved << "/" << targets.size() << " targets solved in " << seconds * 1e3 << " ms" << endl;
+    return solved == targets.size() ? 0 : 2;
+}
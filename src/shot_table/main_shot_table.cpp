@@ -0,0 +1,120 @@
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "q234.hpp"
+#include "philox.hpp"
+#include "shot_surrogate.hpp"
+
+using namespace std;
+
+/* Surrogate table of the shots from the Q4 spot (20 m out, 3 m left
+ * of centre):
+ *
+ *   shot_table build <file> [-j threads] [--dt dt]
+ *   shot_table query <file> v0 elevation_deg azimuth_deg spin
+ *   shot_table bench <file> [queries]
+ *
+ * build tabulates the default grid and prints the validation against
+ * direct integration, query prints one interpolated crossing with its
+ * error bounds, bench times random queries. */
+int main(int argc, char* argv[]) {
+    vector<string> args;
+    size_t nthreads = 0;
+    float dt = 0.01f;
+    for (int i = 1; i < argc; ++i) {
+        string arg = argv[i];
+        if (arg == "-j" && i + 1 < argc) {
+            nthreads = strtoul(argv[++i], nullptr, 10);
+        } else if (arg == "--dt" && i + 1 < argc) {
+            dt = float(atof(argv[++i]));
+        } else {
+            args.push_back(arg);
+        }
+    }
+    if (args.size() < 2) {
+        cerr << "Usage: shot_table build|query|bench <file> ..." << endl;
+        return 1;
+    }
+    const string& mode = args[0];
+    const string& file = args[1];
+    const float deg = float(M_PI / 180.0);
+
+    ShotSurrogate table;
+    if (mode == "build") {
+        ShotLaunch origin;
+        origin.x = float(PITCH_L / 2 - 20.0);
+        origin.y = 3.0f;
+        origin.z = float(R_BALL);
+        origin.speed = origin.elevation = origin.azimuth = origin.spin_z = 0.0f;
+
+        ThreadPool pool(nthreads);
+        auto start = chrono::steady_clock::now();
+        table.build(default_surrogate_grid(), origin, dt, BallPhysics(), pool);
+        double secs = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        if (!table.save(file)) {
+            cerr << "Error: could not write " << file << endl;
+            return 1;
+        }
+
+        const SurrogateHeader& h = table.header();
+        cout << h.nodes << " nodes (" << h.nodes * sizeof(SurrogateNode) / (1 << 20) << " MiB) in " << setprecision(3)
+             << secs << " s" << endl;
+        cout << "Validation at " << h.validation_samples << " random shots: max error t " << h.max_error_t
+             << " s, y " << h.max_error_y << " m, z " << h.max_error_z << " m" << endl;
+        cout << "  outside the stated bound: " << h.bound_violations << ", uncertain outcomes: "
+             << h.uncertain_outcomes << ", wrong certain outcomes: " << h.outcome_mismatches << endl;
+        return 0;
+    }
+
+    if (!table.open(file)) {
+        cerr << "Error: " << file << " is not a surrogate table" << endl;
+        return 1;
+    }
+
+    if (mode == "query") {
+        if (args.size() < 6) {
+            cerr << "Usage: shot_table query <file> v0 elevation_deg azimuth_deg spin" << endl;
+            return 1;
+        }
+        SurrogateHit hit = table.query(float(atof(args[2].c_str())), float(atof(args[3].c_str())) * deg,
+                                       float(atof(args[4].c_str())) * deg, float(atof(args[5].c_str())));
+        cout << fixed << setprecision(4);
+        cout << shot_outcome_name(hit.outcome) << (hit.outcome_certain ? "" : " (uncertain)")
+             << (hit.in_range ? "" : " (outside the table)") << endl;
+        cout << "t = " << hit.t << " +- " << hit.err_t << " s" << endl;
+        cout << "y = " << hit.y << " +- " << hit.err_y << " m" << endl;
+        cout << "z = " << hit.z << " +- " << hit.err_z << " m" << endl;
+        return 0;
+    }
+
+    if (mode == "bench") {
+        size_t nq = args.size() > 2 ? strtoul(args[2].c_str(), nullptr, 10) : 10000000;
+        const SurrogateGrid& g = table.header().grid;
+        vector<float> q(4 * 4096);
+        Philox4x32 rng(7);
+        for (size_t k = 0; k < 4096; ++k) {
+            array<double, 4> u = rng.uniform({uint32_t(k), 0u, 0u, 0u});
+            for (int d = 0; d < 4; ++d) {
+                q[4 * k + size_t(d)] = g.axis[d].lo + float(u[size_t(d)]) * (g.axis[d].hi - g.axis[d].lo);
+            }
+        }
+
+        size_t good = 0;
+        auto start = chrono::steady_clock::now();
+        for (size_t i = 0; i < nq; ++i) {
+            const float* p = &q[4 * (i % 4096)];
+            good += table.query(p[0], p[1], p[2], p[3]).outcome == ShotOutcome::Good;
+        }
+        double secs = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        cout << nq << " queries, " << setprecision(3) << 1e9 * secs / double(nq) << " ns/query ("
+             << double(good) / double(nq) << " GOOD)" << endl;
+        return 0;
+    }
+
+    cerr << "Error: unknown mode " << mode << endl;
+    return 1;
+}